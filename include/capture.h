@@ -0,0 +1,67 @@
+// File: capture.h
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "decrypt.h"      // NUM_BLOCKS, BLOCK_BYTES, Ht
+#include "error_bits.h"   // CAPTURE_BATCH_MAX
+
+/*
+ * 여러 캡처(암호문/scramble 쌍) 일괄 처리
+ *
+ * 한 캡처는 data/ciphertext.bin 과 같은 형식(블록 NUM_BLOCKS 개 × BLOCK_BYTES,
+ * MSB-first)의 암호문과 BLOCK_BYTES 바이트 scramble 입니다. R4 판정에서 캡처가
+ * 들어가는 곳은 우변의 c_j·Ht (블록당 48비트) 뿐이므로 캡처 하나는 word
+ * NUM_BLOCKS 개로 줄어들고, R4 마다의 CtHt·소거는 모든 캡처가 나눠 씁니다.
+ *
+ * 캡처 목록은 두 가지로 만듭니다.
+ *   manifest   줄마다 "암호문 [scramble]". 빈 줄과 # 뒤는 무시, scramble 이 없으면 기본값
+ *   디렉터리   크기가 NUM_BLOCKS × BLOCK_BYTES 인 *.bin 이 암호문 (이름순). 다른 크기의
+ *              *.bin (H.bin, Gt.bin 등) 은 건너뜁니다. <이름>.s.bin 이 있으면 그 scramble,
+ *              없으면 기본값
+ */
+
+typedef struct {
+    size_t  n, cap;
+    char  **cipher;      // 암호문 경로
+    char  **scramble;    // scramble 경로
+} capture_list_t;
+
+/* 한 번의 sweep 에서 함께 판정하는 캡처 묶음 */
+typedef struct {
+    int    n;
+    size_t index[CAPTURE_BATCH_MAX];            // capture_list_t 안의 번호
+    word   cht[CAPTURE_BATCH_MAX][NUM_BLOCKS];  // 블록 j 의 (c_j ⊕ s)·Ht, bit r = 행 r
+} capture_batch_t;
+
+/**
+ * @brief  암호문과 scramble 을 읽어 cht[j] = (c_j ⊕ s)·Ht 를 계산합니다.
+ *         전역 c_vecs / cHt_vecs 는 건드리지 않습니다. init_H() 가 먼저 호출되어 있어야 합니다.
+ * @return 0 성공, -1 실패 (파일 없음, 크기 불일치)
+ */
+int capture_load_cht(const char *cipher_path, const char *scramble_path,
+                     word cht[NUM_BLOCKS]);
+
+/** 목록 끝에 한 쌍을 추가합니다 (경로는 복사). @return 0 성공, -1 실패 */
+int capture_list_add(capture_list_t *list, const char *cipher_path, const char *scramble_path);
+
+/** manifest 파일로 목록을 만듭니다. @return 0 성공, -1 실패 (이번에 추가한 항목은 되돌림) */
+int capture_list_from_manifest(capture_list_t *list, const char *path,
+                               const char *default_scramble);
+
+/** 디렉터리의 암호문으로 목록을 만듭니다. @return 0 성공, -1 실패 (이번에 추가한 항목은 되돌림) */
+int capture_list_from_dir(capture_list_t *list, const char *dir,
+                          const char *default_scramble);
+
+void capture_list_free(capture_list_t *list);
+
+/**
+ * @brief  목록의 [first, first+count) 캡처를 batch 에 읽어 들입니다 (count ≤ CAPTURE_BATCH_MAX).
+ *         읽지 못한 캡처는 stderr 에 알리고 건너뜁니다.
+ * @return 건너뛴 캡처 수
+ */
+int capture_batch_load(capture_batch_t *batch, const capture_list_t *list,
+                       size_t first, size_t count);
+
+#endif // CAPTURE_H
@@ -0,0 +1,172 @@
+// File: ctht_cache.h
+#ifndef CTHT_CACHE_H
+#define CTHT_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <m4ri/m4ri.h>
+#include "decrypt.h"   // TOTAL_VARS, H_ROWS, R4_SPACE
+
+// CtHt 한 개 = 656×48. 48열이므로 한 행이 word 하나에 들어갑니다.
+#define CTHT_ROWS         TOTAL_VARS
+#define CTHT_COLS         H_ROWS
+#define CTHT_ENTRY_WORDS  CTHT_ROWS      // R4 하나당 word 수
+
+/*
+ * CtHt 캐시 파일 (host byte order)
+ *
+ *   off  size  field
+ *   0    8     magic "CTHTCACH"
+ *   8    4     version (CTHT_FILE_VERSION)
+ *   12   4     byte-order mark 0x01020304
+ *   16   4     entries          (R4_SPACE)
+ *   20   4     rows             (CTHT_ROWS)
+ *   24   4     cols             (CTHT_COLS)
+ *   28   4     words per entry  (CTHT_ENTRY_WORDS)
+ *   32   8     payload offset   (CTHT_FILE_PAYLOAD_OFFSET)
+ *   40   8     payload bytes
+ *   48   8     Ht digest        (다른 H로 만든 캐시를 거부)
+ *   56   8     payload checksum (ctht_file_verify)
+ *   ...  0 패딩
+ *   4096       payload: R4 오름차순, 각 R4마다 656 word.
+ *              word r 의 bit j = CtHt[r][j] (48열 mzd 행과 같은 배치)
+ *
+ * payload가 페이지 정렬되어 있으므로 mmap 한 페이지 위에 바로 mzd_t 뷰를
+ * 만들 수 있고, 같은 호스트의 여러 프로세스가 page cache 한 벌을 공유합니다.
+ */
+#define CTHT_FILE_MAGIC           "CTHTCACH"
+#define CTHT_FILE_VERSION         1
+#define CTHT_FILE_PAYLOAD_OFFSET  4096
+#define CTHT_FILE_DEFAULT_PATH    "data/ctht_cache.bin"
+
+typedef struct {
+    void       *base;       // mmap 시작 주소
+    size_t      len;        // mmap 길이
+    const word *payload;    // R4_SPACE × CTHT_ENTRY_WORDS
+    uint64_t    checksum;   // 헤더에 기록된 payload checksum
+} ctht_map_t;
+
+// R4 하나의 CtHt를 dst[CTHT_ENTRY_WORDS] 에 채우는 콜백
+typedef void (*ctht_fill_fn)(uint16_t r4, word *dst, void *user);
+
+/** Ht(208×48)의 digest. 캐시 파일이 같은 H로 만들어졌는지 확인하는 데 씁니다. */
+uint64_t ctht_ht_digest(const mzd_t *Ht);
+
+/** 656×48 mzd 를 CTHT_ENTRY_WORDS 개의 word로 복사합니다. */
+void ctht_pack_entry(const mzd_t *CtHt, word *dst);
+
+/**
+ * @brief  fill 콜백으로 R4 = 0..R4_SPACE-1 을 차례로 받아 캐시 파일을 씁니다.
+ *         "<path>.tmp" 에 쓴 뒤 fsync 하고 rename 합니다.
+ * @return 0 성공, -1 실패
+ */
+int ctht_file_write(const char *path, const mzd_t *Ht,
+                    ctht_fill_fn fill, void *user);
+
+/**
+ * @brief  캐시 파일을 읽기 전용으로 mmap 합니다.
+ *         헤더, 크기, Ht digest 만 확인하므로 payload 크기와 무관하게 빠릅니다.
+ * @return 0 성공, -1 실패 (파일 없음, 버전/형식/Ht 불일치)
+ */
+int ctht_file_map(const char *path, const mzd_t *Ht, ctht_map_t *m);
+
+/** payload 전체의 checksum을 다시 계산해 헤더와 비교합니다. 0 일치, -1 불일치. */
+int ctht_file_verify(const ctht_map_t *m);
+
+void ctht_file_unmap(ctht_map_t *m);
+
+/*
+ * slab: R4 n개의 CtHt를 하나의 연속 배열(n × CTHT_ENTRY_WORDS word)에 담고,
+ * 각 항목의 656×48 뷰 헤더(mzd_t)도 한 배열에 미리 만들어 둡니다.
+ * 개별 mzd_init/mzd_free 가 없으므로 힙 단편화가 없고, R4 순서대로 훑을 때
+ * 메모리 접근이 순차적입니다. 뷰는 m4ri 창(windowed)이므로 기존 코드에서
+ * 일반 mzd_t 처럼 읽고 창을 만들 수 있지만 mzd_free 해서는 안 됩니다.
+ */
+typedef struct {
+    word     *data;       // n × CTHT_ENTRY_WORDS, 페이지 정렬
+    mzd_t    *views;      // n 개의 뷰 헤더
+    uint32_t  n;
+    bool      owns_data;  // false 이면 data는 mmap 된 캐시 파일 payload
+} ctht_slab_t;
+
+/**
+ * @brief  n개 항목짜리 0으로 초기화된 slab을 만듭니다.
+ *         익명 mmap 으로 잡으므로 실제로 쓴 항목의 페이지만 RSS에 잡힙니다.
+ * @return 0 성공, -1 실패
+ */
+int  ctht_slab_init(ctht_slab_t *s, uint32_t n);
+
+/** 매핑된 캐시 파일의 payload 위에 R4_SPACE 항목 slab을 만듭니다 (읽기 전용). */
+int  ctht_slab_init_mapped(ctht_slab_t *s, const ctht_map_t *m);
+
+void ctht_slab_free(ctht_slab_t *s);
+
+static inline word *ctht_slab_entry(const ctht_slab_t *s, uint32_t i) {
+    return s->data + (size_t)i * CTHT_ENTRY_WORDS;
+}
+
+static inline mzd_t *ctht_slab_view(const ctht_slab_t *s, uint32_t i) {
+    return &s->views[i];
+}
+
+/*
+ * 용량이 제한된 CtHt 캐시 (clock 교체, 필요할 때 계산)
+ *
+ * capacity 개의 slot을 가진 slab 하나에 최근에 쓴 R4들만 둡니다.
+ * ctht_lru_acquire() 는 항목을 pin 하고 뷰를 돌려주며, 없으면 참조 비트가
+ * 꺼진 pin 안 된 slot을 골라(clock) 비우고 fill 콜백으로 계산합니다.
+ * 계산은 잠금 밖에서 하므로 서로 다른 R4는 동시에 만들어지고,
+ * 같은 R4를 동시에 요청하면 한 스레드만 계산하고 나머지는 기다립니다.
+ * 쓰고 나면 ctht_lru_release() 로 pin 을 풀어야 교체 대상이 됩니다.
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;       // 계산 횟수
+    uint64_t evictions;    // 다른 R4를 위해 밀려난 항목 수
+} ctht_lru_stats_t;
+
+typedef struct {
+    ctht_slab_t      slab;       // capacity 항목
+    uint32_t         capacity;
+    int32_t         *slot_of;    // [R4_SPACE] → slot, 없으면 -1
+    int32_t         *r4_of;      // [capacity] → R4, 빈 slot 이면 -1
+    uint32_t        *pins;       // [capacity]
+    uint8_t         *ref;        // [capacity] clock 참조 비트
+    uint8_t         *ready;      // [capacity] 계산 완료 여부
+    uint32_t         hand;       // clock 바늘
+    pthread_mutex_t  lock;
+    pthread_cond_t   changed;    // 계산 완료 또는 pin 해제
+    ctht_fill_fn     fill;
+    void            *user;
+    ctht_lru_stats_t stats;
+} ctht_lru_t;
+
+/**
+ * @brief  capacity 개 항목짜리 캐시를 만듭니다 (1 <= capacity <= R4_SPACE).
+ * @param  fill  R4 하나의 CtHt를 CTHT_ENTRY_WORDS word로 채우는 함수 (스레드 안전해야 함)
+ * @return 0 성공, -1 실패
+ */
+int  ctht_lru_init(ctht_lru_t *c, uint32_t capacity, ctht_fill_fn fill, void *user);
+void ctht_lru_free(ctht_lru_t *c);
+
+/**
+ * @brief  R4의 CtHt 뷰를 pin 해서 돌려줍니다. 없으면 계산합니다.
+ *         모든 slot 이 pin 되어 있으면 하나가 풀릴 때까지 기다립니다.
+ */
+const mzd_t *ctht_lru_acquire(ctht_lru_t *c, uint16_t r4);
+
+/** acquire 한 R4의 pin 을 풉니다. 이후 뷰는 다른 R4로 덮어써질 수 있습니다. */
+void ctht_lru_release(ctht_lru_t *c, uint16_t r4);
+
+void ctht_lru_get_stats(ctht_lru_t *c, ctht_lru_stats_t *out);
+
+/**
+ * @brief  entry(CTHT_ENTRY_WORDS word) 위의 656×48 zero-copy 뷰.
+ *         mzd_free() / mzd_free_window() 로 헤더만 해제됩니다.
+ * @note   mmap 된 페이지는 읽기 전용이므로 뷰에 쓰면 안 됩니다.
+ */
+mzd_t *ctht_view_init(const word *entry);
+
+#endif // CTHT_CACHE_H
@@ -13,6 +13,7 @@
 
 // constants for variable layout
 #define C_ROWS     208
+#define H_ROWS     48   // 패리티 검사 행 수 (H: 48×208)
 #define CONSTANT_TERM_INDEX 0
 #define VAR_LEN_R1 171 // 19 + 18 + 17 + ... + 1 = 171
 #define VAR_OFF_R1 1 // 0th index is constant term
@@ -29,10 +30,10 @@
 #define R4_SPACE  (1<<16)
 // 기존 extern 선언들…
 extern mzd_t *H, *Ht;
+// CtHt_cache[r4]: 656×48, 하나의 slab(ctht_cache.h) 위의 읽기 전용 뷰. mzd_free 하지 말 것.
 extern mzd_t *CtHt_cache[R4_SPACE];
 extern mzd_t *c_vecs[NUM_BLOCKS];
 extern mzd_t *cHt_vecs[NUM_BLOCKS];
-extern mzd_t  *V_DIFF_MATS[V_DIFF_COUNT];
 // 서브시스템 초기화/해제 함수 선언
 void init_H(void);
 void free_H(void);
@@ -44,6 +45,18 @@ void free_v_diff_matrices(void);
 
 void init_CtHt_cache(void);
 void free_CtHt_cache(void);
+// 캐시 파일(ctht_cache.h 형식)을 mmap 하여 CtHt_cache[] 를 zero-copy 뷰로 채웁니다.
+// init_H() 이후에 호출. 0 성공, -1 실패 (이 경우 CtHt_cache[] 는 그대로)
+int  init_CtHt_cache_from_file(const char *path);
+// CtHt(656×48, 미리 할당)에 Cᵀ·Ht 를 계산. 캐시는 건드리지 않습니다.
+void build_CtHt_for_r4(uint16_t R4, mzd_t *CtHt);
+// 같은 결과를 dst[656] word(행 v의 bit j = CtHt[v][j])에 씀. C를 만들지 않고
+// 키스트림 행마다 Ht 행을 rank-1 XOR 로 누적합니다. 스레드 안전.
+void build_CtHt_words_for_r4(uint16_t R4, word *dst);
+// C 생성 → 전치 → mzd_mul_naive 로 계산하는 원본 경로 (검증용)
+void build_CtHt_for_r4_ref(uint16_t R4, mzd_t *CtHt);
+// ctht_fill_fn 어댑터: R4의 CtHt를 dst[656] word에 채움 (user 미사용, 스레드 안전)
+void CtHt_fill_entry(uint16_t R4, word *dst, void *user);
 
 void init_cHt_vecs(void);
 void free_cHt_vecs(void);
@@ -55,6 +68,17 @@ void free_v_diff_matrices(void);
 void init_globals(void);
 void free_globals(void);
 
+// 캡처(암호문)와 무관한 공통 전역 상태(패턴, LFSR 행렬, H, V_DIFF)만 초기화. CtHt slab 은 처음 쓸 때 잡습니다.
+// CIPHERTEXT_PATH 가 없어도 됩니다 (capture.h 의 일괄 모드). 여러 번 호출해도 한 번만 수행됩니다.
+void init_globals_shared(void);
+// init_globals_shared + CIPHERTEXT_PATH 캡처의 c_vecs, cHt_vecs.
+// 여러 번 호출해도 한 번만 수행됩니다. 스레드를 띄우기 전에 메인 스레드에서 호출하세요.
+void init_globals_core(void);
+// CtHt_cache[R4] 한 개만 계산. 서로 다른 R4에 대해서는 여러 스레드에서 동시에 호출해도 안전합니다.
+void init_CtHt_for_r4(uint16_t R4);
+// init_globals_core + init_CtHt_for_r4
+void init_globals_for_r4(uint16_t R4);
+
 unsigned char *load_packed_bin(const char *path, size_t *out_bytes  );
 mzd_t *load_packed_matrix(const char *path, int rows, int cols);
 //------------------------------------------------------------------------------
@@ -69,20 +93,53 @@ typedef struct {
     mzd_t*        L;           // reg_len×4 basis matrix E or A^k·E
     mzd_t*        row;         // 1×TOTAL_VARS accumulated coefficients
 } LSegment;
-// 전역 변환 행렬 배열: 블럭 i(1..14)에 대응
-extern mzd_t *V_DIFF_MATS[V_DIFF_COUNT];
+/*
+ * 블럭 i(1..14)의 변수 치환 v_i = v_0 · M_i.  M_i = I + N_i 이고 N_i 는 row 0(상수항)과
+ * 2차항이 걸린 1차 변수 행에만 0 아닌 칸이 있으므로, 그 칸들만 행별(CSR)로 저장합니다.
+ * 행 rows[k] 의 off-diagonal 열은 cols[start[k] .. start[k+1]) 입니다.
+ */
+typedef struct {
+    int       nrows;    // N 이 0 아닌 행 수
+    uint16_t *rows;     // [nrows] 행 번호 (오름차순)
+    uint32_t *start;    // [nrows+1]
+    uint16_t *cols;     // [start[nrows]] 열 번호 (행 안에서는 순서 없음)
+} v_diff_t;
+
+// off-diagonal 칸 수 상한: 1차항 (상수 행) + 2차항마다 최대 3칸 (상수 행, 두 1차항 행)
+#define V_DIFF_MAX_NNZ  (3 * V_DIFF_SIZE)
+
+// 전역 치환 배열: V_DIFF[i-1] 이 블럭 i 에 대응
+extern v_diff_t V_DIFF[V_DIFF_COUNT];
 
 /**
- * @brief V_DIFF_MATS를 초기화합니다.
+ * @brief V_DIFF를 초기화합니다.
  * - lfsr_matrices_init() 으로 zS_R1..R4를 로드
- * - 각 V_DIFF_MATS[i]에 656×656 단위행렬을 만들고,
- *   zS_R1..R3 행(i)에서 가져온 1차차분 및 2차차분을
- *   해당 변환행렬의 열로 반영합니다.
+ * - zS_R1..R3 행(i)에서 가져온 1차차분 및 2차차분으로 N_i 의 칸을 모읍니다.
  */
 void init_v_diff_matrices(void);
 
 /**
- * @brief V_DIFF_MATS에 할당된 모든 행렬을 해제합니다.
+ * @brief dst = M_{i+1} · X  (X: 656×k, dst: 656×k, dst ≠ X)
+ *        X를 복사한 뒤 N 이 0 아닌 행에만 해당 X 행들을 XOR 합니다.
+ */
+void v_diff_mul(mzd_t *dst, int i, const mzd_t *X);
+
+/** @brief v_diff_mul 의 한 열 word 판 (k ≤ 64): dst[r] = (M_{i+1} · X)[r], 각 656 word, dst ≠ X */
+void v_diff_mul_words(word *dst, int i, const word *X);
+
+/**
+ * @brief dst = v · M_{i+1}  (v, dst: 1×656, dst ≠ v). 블럭 0 의 v 로 블럭 i+1 의 v 를 얻습니다.
+ */
+void v_diff_apply_vec(mzd_t *dst, int i, const mzd_t *v);
+
+/** @brief M_{i+1} 을 656×656 dense 행렬로 만듭니다 (검증용, 호출자가 mzd_free). */
+mzd_t *v_diff_to_dense(int i);
+
+/** @brief M_{i+1} 을 zS_R1..R3 에서 곧바로 dense 로 만드는 원본 구현 (검증용, 호출자가 mzd_free). */
+mzd_t *v_diff_to_dense_ref(int i);
+
+/**
+ * @brief V_DIFF에 할당된 모든 배열을 해제합니다.
  */
 void free_v_diff_matrices(void);
 //------------------------------------------------------------------------------
@@ -96,17 +153,29 @@ void init_LSegment(LSegment* seg,
                    uint8_t  r
                  );
 void update_LSegment(LSegment* seg);
+// L ← A^k × L (0 <= k <= LFSR_POW_MAX), 사전 계산된 A_pow 표 사용
+void update_LSegment_k(LSegment* seg, int k);
 void free_LSegment(LSegment* seg);
 
 /**
  * Build the linear system on‑the‑fly:
- *  - dcol: 208×1 column of constant terms
+ *  - C: 208×656, 미리 할당 (내용은 덮어씀)
+ *  - 탭 열을 워드 비트마스크로 clock 하고 C 행을 워드 단위로 채웁니다.
  */
 void build_linear_system_with_pattern(
     const uint8_t* pattern,
     mzd_t*        C
 );
 
+/**
+ * 위와 같은 C를 LSegment/mzd 연산으로 만드는 원본 구현 (검증용, 느림).
+ *  - C: 208×656, 0행렬이어야 함
+ */
+void build_linear_system_with_pattern_ref(
+    const uint8_t* pattern,
+    mzd_t*        C
+);
+
 
 /**
  * Generate the keystream z_vec using the linear system and current LFSR state.
@@ -62,6 +62,43 @@ void normalize_lsb(lfsr_matrix_state_t* state);
 // keystream 생성
 void keystream_generation_with_pattern_m4ri(const lfsr_matrix_state_t* state, const uint8_t* pattern, mzd_t* z_vec);
 
+// keystream 을 word 에 packed 로 (bit j of z[j/64] = z_j)
+#define KEYSTREAM_WORDS ((CIPHERTEXT_SIZE + 63) / 64)
+
+// 같은 keystream 을 uint32 레지스터로 생성 (할당 없음, 스레드 안전). R4 는 쓰지 않음.
+void keystream_generation_with_pattern_u32(const lfsr_u32_state_t* state, const uint8_t* pattern,
+                                           word z[KEYSTREAM_WORDS]);
+
+// ── packed 인코더: e = p·Gt ────────────────────────────────────────────
+// 평문 바이트 i (MSB-first, 비트 7-b = 평문 비트 8i+b) 값 v 마다 208비트 부호어를 미리 XOR 해 둔
+// 표. 블록 하나는 ENC_PT_BLOCK_BYTES 번 조회해 XOR 하면 됩니다 (M4RM 의 8비트 창과 같은 방식).
+#define ENC_PT_BLOCK_BYTES  (PLAINTEXT_BLOCK_SIZE / 8)   // 20
+#define ENC_CT_BLOCK_BYTES  (CIPHERTEXT_SIZE / 8)        // 26
+
+typedef struct {
+    word tab[ENC_PT_BLOCK_BYTES][256][KEYSTREAM_WORDS];   // bit j = 부호어 j번째 비트
+} gt_encoder_t;
+
+// Gt: CIPHERTEXT_SIZE × PLAINTEXT_BLOCK_SIZE row-major int (encrypt_m4ri 와 같은 형식)
+void gt_encoder_init(gt_encoder_t* enc, const int* Gt);
+
+static inline void gt_encode_block(const gt_encoder_t* enc, const uint8_t* pt, word e[KEYSTREAM_WORDS]) {
+    for (int w = 0; w < KEYSTREAM_WORDS; w++) e[w] = 0;
+    for (int i = 0; i < ENC_PT_BLOCK_BYTES; i++) {
+        const word* row = enc->tab[i][pt[i]];
+        for (int w = 0; w < KEYSTREAM_WORDS; w++) e[w] ^= row[w];
+    }
+}
+
+// 평문 nblocks 블록(ENC_PT_BLOCK_BYTES 씩 연속)을 E(nblocks × CIPHERTEXT_SIZE)의 각 행에 인코딩
+void gt_encode_batch(const gt_encoder_t* enc, const uint8_t* pt, rci_t nblocks, mzd_t* E);
+
+// bitsliced keystream: 최대 KS_BS_LANES 개 상태를 word 의 비트 하나씩(lane)에 놓고 한 번에 생성.
+// 패턴 표 대신 lane 마다 R4 를 함께 clock 하고 majority(R4[1],R4[6],R4[15]) 로 clock mask 를 만듭니다.
+// states[l].R4 는 17비트 전체 (bit 0 포함), z[l] 은 lane l 의 keystream.
+#define KS_BS_LANES 64
+void keystream_generation_bs(const lfsr_u32_state_t* states, int n, word z[][KEYSTREAM_WORDS]);
+
 // 암호화 메인 함수
 void encrypt(
     const int key[KEY_SIZE],
@@ -86,6 +123,15 @@ void encrypt_m4ri(const int key[KEY_SIZE], const char* plaintext, int err1, int
 
 void lfsr_enc_m4ri(const int K[KEY_SIZE], const int N[NONCE_SIZE], int z[CIPHERTEXT_SIZE]);
 
+// lfsr_enc_m4ri 의 1)~3) 단계: 키 스케줄과 키 인젝션을 마친 초기 상태
+void lfsr_key_setup_m4ri(const int K[KEY_SIZE], const int N[NONCE_SIZE], lfsr_u32_state_t* out);
+
+// 같은 초기 상태를 표로 계산합니다. K 는 bit i = K[i], N 은 bit j = N[j].
+// 0 상태에서 시작하는 키 인젝션은 aa 에 대해 선형이므로 키 8바이트·nonce 3바이트마다
+// 256개 응답을 미리 XOR 해 둔 표(스케줄·비트 리버설 포함)를 11번 조회해 XOR 합니다.
+// 표는 처음 호출할 때 한 번 만들어집니다 (스레드 안전).
+void lfsr_key_setup(uint64_t K, uint32_t N, lfsr_u32_state_t* out);
+
 
 
 
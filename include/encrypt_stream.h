@@ -0,0 +1,68 @@
+// File: encrypt_stream.h
+#ifndef ENCRYPT_STREAM_H
+#define ENCRYPT_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "encrypt.h"   // KEYSTREAM_WORDS, KS_BS_LANES, lfsr_key_setup, gt_encoder_t
+
+/*
+ * 스트리밍 암호화 컨텍스트
+ *
+ * 평문을 임의 크기 조각으로 받아 20바이트(160비트) 블록이 찰 때마다 26바이트(208비트)
+ * 암호문 블록을 바로 씁니다. 블록 i 의 nonce 는 frame 번호 first_frame + i 의 하위
+ * NONCE_SIZE 비트이므로 15블록 제한이 없습니다 (encrypt_m4ri 는 FN = 9867 부터 15개).
+ *
+ * 바이트 안 비트 순서는 기존 파일 형식과 같습니다 (MSB-first):
+ *   평문   비트 k = in[k/8]  >> (7 - k%8)
+ *   암호문 비트 j = out[j/8] >> (7 - j%8)     (data/ciphertext.bin 과 같은 배치)
+ *
+ * keystream 은 keystream_generation_bs 로 frame 최대 KS_BS_LANES 개씩 미리 만들어 둡니다.
+ * 인코딩은 gt_encoder_t 표로 하고, 인코딩·s·keystream 모두 packed word 로 XOR 합니다.
+ * 인코더는 읽기만 하므로 같은 Gt 를 쓰는 여러 스트림이 하나를 공유할 수 있습니다.
+ */
+typedef struct {
+    uint64_t key;                                      // bit i = K[i]
+    uint32_t frame;                                    // 다음 블록의 frame 번호
+    word     s[KEYSTREAM_WORDS];                       // scramble, bit j = s[j]
+    const gt_encoder_t *enc;                           // 공유 인코더 (스트림보다 오래 살아야 함)
+
+    uint8_t  pending[ENC_PT_BLOCK_BYTES];              // 아직 블록이 안 찬 평문
+    size_t   npending;
+
+    word     z[KS_BS_LANES][KEYSTREAM_WORDS];          // 미리 만든 keystream (frame 순)
+    int      z_count;
+    int      z_next;
+} encrypt_stream_t;
+
+/**
+ * @brief  컨텍스트를 초기화합니다.
+ * @param  key          KEY_SIZE 개 비트 (0/1)
+ * @param  first_frame  첫 블록의 frame 번호
+ * @param  s            CIPHERTEXT_SIZE 개 비트
+ * @param  enc          gt_encoder_init 으로 만든 인코더
+ */
+void encrypt_stream_init(encrypt_stream_t *st, const int key[KEY_SIZE], uint32_t first_frame,
+                         const int *s, const gt_encoder_t *enc);
+
+/** update 가 len 바이트를 받았을 때 쓰게 될 암호문 바이트 수 */
+static inline size_t encrypt_stream_out_size(const encrypt_stream_t *st, size_t len) {
+    return (st->npending + len) / ENC_PT_BLOCK_BYTES * ENC_CT_BLOCK_BYTES;
+}
+
+/**
+ * @brief  평문 len 바이트를 받아 완성된 블록의 암호문을 out 에 씁니다.
+ *         남은 바이트는 다음 update/final 까지 보관합니다.
+ * @param  out  encrypt_stream_out_size(st, len) 바이트 이상
+ * @return 쓴 바이트 수 (ENC_CT_BLOCK_BYTES 의 배수)
+ */
+size_t encrypt_stream_update(encrypt_stream_t *st, const uint8_t *in, size_t len, uint8_t *out);
+
+/**
+ * @brief  남은 평문이 있으면 0으로 채워 마지막 블록 하나를 씁니다.
+ * @param  out  ENC_CT_BLOCK_BYTES 바이트 이상
+ * @return 쓴 바이트 수 (0 또는 ENC_CT_BLOCK_BYTES)
+ */
+size_t encrypt_stream_final(encrypt_stream_t *st, uint8_t *out);
+
+#endif // ENCRYPT_STREAM_H
@@ -8,43 +8,60 @@
 #error "NUM_BLOCKS must be defined before including error_bits.h"
 #endif
 
-/* 블록당 최대 추적할 수 있는 오류 비트 수 */
-#define MAX_ERROR_BITS_PER_BLOCK 2
-
-/* 블록 단위 오류 상태 */
-typedef enum {
-    BLOCK_NO_ERROR = 0,        /* 해당 블록에 오류 없음 */
-    BLOCK_ERROR_UNKNOWN_POS,   /* 오류는 있으나 위치 미확인 */
-    BLOCK_ERROR_KNOWN_POS      /* 오류 위치까지 모두 확인됨 */
-} block_error_status_t;
+/*
+ * 오류 설정 공간: unknown 블록 하나에는 위치를 모르는 오류가 있고, 선택적으로
+ * 다른 known 블록 하나에 pos 위치 단일 비트 오류가 있습니다.
+ * 설정은 (unknown, known, pos) 곱공간이므로 목록을 만들지 않고 인덱스로 열거합니다.
+ * unknown 마다 ERROR_CONFIG_SEGMENT 개씩 연속 구간이며, 구간 안에서는
+ *   +0                         known 없음
+ *   +1 + k*CIPHERTEXT_SIZE + pos  known = unknown 을 뺀 k번째 블록
+ * 순서입니다.
+ */
+#define ERROR_CONFIG_SEGMENT  (1 + (NUM_BLOCKS - 1) * CIPHERTEXT_SIZE)
+#define ERROR_CONFIG_COUNT    ((size_t)NUM_BLOCKS * ERROR_CONFIG_SEGMENT)
 
-/* 개별 블록의 오류 정보 */
-typedef struct {
-    block_error_status_t status;
-    int                     error_bits_count;                  /* 알려진 오류 비트 개수 (0 ~ MAX_ERROR_BITS_PER_BLOCK) */
-    int                     error_position;
-                                                               /* 오류 비트 인덱스 (0-based, 블록 내 비트 위치) */
-    mzd_t*                  syndrome;                          /* 이 블록의 시냅스 행렬 */
-} block_error_t;
-
-/* 전체 블록 오류 집합 */
 typedef struct {
-    block_error_t blocks[NUM_BLOCKS];
-} error_bits_t;
+    int8_t   unknown;   /* 위치를 모르는 오류 블록 */
+    int8_t   known;     /* 위치를 아는 오류 블록, 없으면 -1 */
+    uint8_t  pos;       /* known 블록 안 오류 비트 위치 (0 … CIPHERTEXT_SIZE-1) */
+} error_config_t;
 
+/* 모든 설정이 공유하는 syndrome 표 (H 에서 한 번 계산) */
 typedef struct {
-    error_bits_t *list;
-    size_t        count;
+    size_t count;                       /* ERROR_CONFIG_COUNT */
+    word   syndrome[CIPHERTEXT_SIZE];   /* H의 pos 열 = pos 단일 비트 오류의 syndrome (bit r = 행 r) */
 } error_config_list_t;
+
+/** syndrome 표를 채웁니다. H가 없으면 init_H() 를 먼저 호출합니다. */
+void error_configs_init(error_config_list_t *configs);
+
+/** idx (0 … ERROR_CONFIG_COUNT-1) 번째 설정 */
+error_config_t error_config_at(size_t idx);
+
+/** cfg 를 인덱스 순서상 다음 설정으로 옮깁니다. 마지막이었으면 false. */
+bool error_config_next(error_config_t *cfg);
+
+/** known 블록 오류의 syndrome (known 이 없으면 0) */
+static inline word error_config_syndrome(const error_config_list_t *configs,
+                                         const error_config_t *cfg)
+{
+    return cfg->known < 0 ? 0 : configs->syndrome[cfg->pos];
+}
+
+#define SOLVER_MAX_ROWS       (NUM_BLOCKS * H_ROWS)   /* A의 최대 행 수 (= b 길이), 15블록 전체 720 */
+#define SOLVER_MAX_ROW_WORDS  ((SOLVER_MAX_ROWS + 63) / 64)   /* m4ri_radix = 64 */
+
 typedef struct {
-    mzd_t    *A_tr;    // RREF된 Aᵀ (n×m)
-    uint32_t pivots[672]; // 최대 pivots
+    word     *rows;    // RREF(Aᵀ)의 pivot 행들, npiv × width word (연속)
+    rci_t     width;   // 행당 word 수 = ceil(m / 64)
+    rci_t     m;       // A의 행 수 (b 길이)
+    uint32_t pivots[SOLVER_MAX_ROWS]; // 최대 pivots
     rci_t     npiv;    // pivots 길이
+
+    int16_t   pivot_row[SOLVER_MAX_ROWS];  // b 좌표 c가 pivot 열이면 그 pivot 행 번호, 아니면 -1
 } solver_ctx_t;
 
-void populate_error_config_syndromes(error_config_list_t *configs);
 
-void generate_error_configs(error_config_list_t *configs);
 bool check_solvability_incremental(mzd_t *A, mzd_t *b);
 
 
@@ -55,6 +72,13 @@ bool check_solvability_incremental(mzd_t *A, mzd_t *b);
  */
 solver_ctx_t *solver_prepare(const mzd_t *A);
 
+/**
+ * @brief  solver_prepare 와 같지만 이미 전치된 Aᵀ (n×m) 를 받아 그 자리에서 RREF 합니다.
+ *         assemble_system_T 결과를 전치·복사 없이 바로 넘길 때 씁니다.
+ * @param  A_tr  n×m, 호출 후 RREF 로 덮어써짐 (해제는 호출자)
+ */
+solver_ctx_t *solver_prepare_transposed(mzd_t *A_tr);
+
 /**
  * @brief  Prepare 없이 이미 컨텍스트 갖고 있다면 solver_prepare를 건너뛰고
  *         직접 ctx를 넘겨 받을 수 있는 checker.
@@ -64,6 +88,30 @@ solver_ctx_t *solver_prepare(const mzd_t *A);
  */
 bool solver_check(const solver_ctx_t *ctx, const mzd_t *b);
 
+/**
+ * @brief  solver_check 의 할당 없는 버전. b를 packed 행으로 받아 그 자리에서 소거합니다.
+ * @param  row  ctx->width word, bit i = b[i] (i ≥ m 인 비트는 0). 호출 후 내용은 바뀝니다.
+ * @return      true iff A·x=b has a solution
+ */
+bool solver_check_row(const solver_ctx_t *ctx, word *row);
+
+/**
+ * @brief  우변 최대 64개를 한 번에 판정합니다. b_j 를 B의 j번째 열로 넣으면
+ *         B의 행 하나가 word 하나이므로 pivot 행 소거가 64개 우변에 동시에 적용됩니다.
+ * @param  B  m×k 행렬 (k ≤ 64). 소거 결과로 덮어써집니다.
+ * @return bit j = A·x = b_j 가 풀리면 1 (j ≥ k 인 비트는 0)
+ */
+word solver_check_batch(const solver_ctx_t *ctx, mzd_t *B);
+
+/**
+ * @brief  단위 벡터 e_c 를 solver_check_row 와 같은 방식으로 소거한 결과를 out 에 씁니다.
+ *         소거는 b에 대해 선형이므로 reduce(b ⊕ e) = reduce(b) ⊕ reduce(e) 이고,
+ *         우변을 조금씩 바꿔 가며 판정할 때 소거된 기본 b에 이 값들을 XOR 해서
+ *         0인지 보면 됩니다 (full RREF 이므로 pivot 행 XOR 한 번).
+ * @param  out  ctx->width word
+ */
+void solver_reduce_bit(const solver_ctx_t *ctx, rci_t c, word *out);
+
 /**
  * @brief  solver_prepare로 할당된 리소스 해제
  * @param  ctx
@@ -73,6 +121,86 @@ void solver_free(solver_ctx_t *ctx);
 void assemble_system(uint16_t R4,
                      mzd_t *A_list[NUM_BLOCKS],
                      mzd_t *b_list[NUM_BLOCKS]); 
+
+/**
+ * @brief  assemble_system과 같지만 이미 할당된 A_list[i](48×655), b_list[i](48×1)에 덮어씁니다.
+ */
+void assemble_system_into(uint16_t R4,
+                          mzd_t *A_list[NUM_BLOCKS],
+                          mzd_t *b_list[NUM_BLOCKS]);
+
+/**
+ * @brief  assemble_system_into와 같지만 CtHt_cache 대신 주어진 656×48 CtHt를 씁니다.
+ *         (ctht_lru_acquire 등 전역 캐시 밖의 CtHt용)
+ */
+void assemble_system_from(const mzd_t *CtHt,
+                          mzd_t *A_list[NUM_BLOCKS],
+                          mzd_t *b_list[NUM_BLOCKS]);
+
+/**
+ * @brief  15블록 전체 시스템을 solver 가 쓰는 전치 형태로 바로 만듭니다.
+ *         AT 의 열 [48j, 48j+48) 에 블록 j 의 A_jᵀ (= S_j 의 1…655행) 를 쓰므로
+ *         assemble_system_from → assemble_A_for_unknown(−1) → 전치 와 같은 결과를
+ *         중간 전치·mzd_stack 없이 얻습니다.
+ * @param  AT      미리 할당된 655×720 (TOTAL_VARS−1 × NUM_BLOCKS·H_ROWS)
+ * @param  b_bits  블록 j 의 우변 48비트 (bit r = b_j[r]), 전역 cHt_vecs 캡처 기준
+ */
+void assemble_system_T(const mzd_t *CtHt, mzd_t *AT, word b_bits[NUM_BLOCKS]);
+
+/* r4_classify_prepared 가 한 번에 판정하는 캡처 수 (캡처별 결과가 word 의 비트 하나) */
+#define CAPTURE_BATCH_MAX  64
+
+/* R4 판정 시 워커마다 하나씩 갖는 작업 공간 */
+typedef struct {
+    mzd_t *AT;                   /* 655×720 전치된 전체 시스템 (assemble_system_T) */
+    word    b0[NUM_BLOCKS];          /* 캡처를 더하기 전의 우변 S_j[0] (b_j = b0[j] ⊕ c_j·Ht) */
+    /* 15블록 전체 시스템을 한 번 소거한 결과 (width = 행당 word 수) */
+    word    *unit;                   /* [블록][H_ROWS] 블록 자리 단위 비트의 소거 결과 */
+    word    *basis;                  /* [블록][≤H_ROWS] 위 unit 들의 XOR basis */
+    uint16_t lead[NUM_BLOCKS][H_ROWS];   /* basis 행마다 대표 비트 */
+    int      nb[NUM_BLOCKS];             /* 블록별 basis 크기 */
+    rci_t    width;
+} r4_scratch_t;
+
+void r4_scratch_init(r4_scratch_t *scratch);
+void r4_scratch_free(r4_scratch_t *scratch);
+
+/**
+ * @brief  R4 의 시스템을 만들고 전체를 한 번 소거해 scratch 에 둡니다 (b0, unit, basis).
+ *         A 는 R4 만으로 정해지므로 결과는 캡처와 무관하고, 여러 캡처가 나눠 씁니다.
+ * @param  CtHt  판정할 R4의 656×48 CtHt
+ */
+void r4_scratch_prepare(const mzd_t *CtHt, r4_scratch_t *scratch);
+
+/**
+ * @brief  r4_scratch_prepare 결과로 캡처 n 개 (≤ CAPTURE_BATCH_MAX) 를 한꺼번에 판정합니다.
+ *         쌍 basis 와 known 블록 이미지는 캡처마다 다시 만들지 않습니다.
+ * @param  cht      cht[c][j] = 캡처 c 의 블록 j 에 대한 c_j·Ht (bit r = 행 r)
+ * @param  invalid  bit c = 캡처 c 에서 is_invalid_r4 가 참
+ * @param  valid    bit c = 캡처 c 에서 is_valid_r4 가 참 (invalid 와 겹치지 않음)
+ */
+void r4_classify_prepared(const r4_scratch_t *scratch,
+                          const error_config_list_t *configs,
+                          const word (*cht)[NUM_BLOCKS], int n,
+                          word *invalid, word *valid);
+
+/**
+ * @brief   두 블록을 unknown으로 뺀 105개 시스템이 모두 풀리지 않으면 true.
+ *          전체 720행 시스템을 한 번만 소거하고, 각 쌍은 그 왼쪽 kernel 로 판정합니다.
+ * @param   CtHt  판정할 R4의 656×48 CtHt (CtHt_cache[R4] 또는 ctht_lru_acquire 결과)
+ */
+bool is_invalid_r4(const mzd_t *CtHt,
+                   const error_config_list_t *configs,
+                   r4_scratch_t *scratch);
+
+/**
+ * @brief   configs 중 하나라도 풀리는 오류 설정이 있으면 true.
+ *          unknown 을 바꿀 때마다 다시 소거하지 않고 전체 시스템 한 번의 소거를 나눠 씁니다.
+ * @param   CtHt  판정할 R4의 656×48 CtHt
+ */
+bool is_valid_r4(const mzd_t *CtHt,
+                 const error_config_list_t *configs,
+                 r4_scratch_t *scratch);
 /**
  * @brief   Given a set of per‐block coefficient matrices A_list (and optional b_list),
  *          build the concatenated “global” A matrix for a specified unknown block.
@@ -80,7 +208,7 @@ void assemble_system(uint16_t R4,
  * @param   A_list    An array of NUM_BLOCKS pointers to already‐assembled block matrices
  *                    (each of dimension H_rows×H_cols, e.g. 48×655).
  * @param   unknown   Index of the block to treat as “unknown” (0 … NUM_BLOCKS−1);
- *                    A_list[unknown] will be omitted.
+ *                    A_list[unknown] will be omitted. −1 stacks all NUM_BLOCKS blocks.
  * @param   A_out     Output pointer; on return *A_out is the stacked matrix of all
  *                    A_list[j] for j≠unknown (dimension (NUM_BLOCKS−1)*H_rows × H_cols).
  *                    Caller must mzd_free(*A_out).
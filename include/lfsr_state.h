@@ -33,6 +33,14 @@ extern mzd_t *A2;  // R2 companion matrix (22×22)
 extern mzd_t *A3;  // R3 companion matrix (23×23)
 extern mzd_t *A4;  // R4 companion matrix (17×17)
 
+// A^k power cache (defined in lfsr_state.c), k = 0..LFSR_POW_MAX
+//   A_pow[r-1][k]         = A_r^k (mzd)
+//   A_pow_cols[r-1][k][j] = A_r^k 의 j번째 열 (bit i = A_r^k[i][j])
+#define LFSR_POW_MAX            CLOCK_PATTERN_LEN
+#define LFSR_POW_MAX_LEN        23
+extern mzd_t   *A_pow[3][LFSR_POW_MAX + 1];
+extern uint32_t A_pow_cols[3][LFSR_POW_MAX + 1][LFSR_POW_MAX_LEN];
+
 // zS‐matrix cache (defined in lfsr_state.c)
 extern mzd_t *zS_R1;  // zS R1 matrix (ZS_ROWS×19)
 extern mzd_t *zS_R2;  // zS R2 matrix (ZS_ROWS×22)
@@ -68,6 +76,54 @@ int  majority_matrix(int a, int b, int c);
 void lfsr_matrices_init(void);
 void lfsr_matrices_cleanup(void);
 
+// ── A^k 점프 ─────────────────────────────────────────────────────────────
+// r(1..3) 레지스터의 열 벡터 x(bit i = x_i)에 A_r^k 를 곱한 결과, k <= LFSR_POW_MAX
+static inline uint32_t lfsr_pow_apply(int r, int k, uint32_t x) {
+    const uint32_t *cols = A_pow_cols[r - 1][k];
+    uint32_t y = 0;
+    while (x) {
+        y ^= cols[__builtin_ctz(x)];
+        x &= x - 1;
+    }
+    return y;
+}
+// pattern[from..to) 동안 각 레지스터(R1,R2,R3)가 clock 되는 횟수
+void lfsr_count_clocks(const uint8_t *pattern, int from, int to, int k[3]);
+
+// ── 네이티브 word LFSR ──────────────────────────────────────────────────
+// mzd 경로(R·A, A = companion 전치)와 같은 배치: bit i = R[i], clock 은 위쪽으로 shift 하고
+// bit 0 에 feedback. tools/gen_r4_patterns.c 의 R4_clock 과 같은 식입니다.
+#define LFSR_R1_LEN 19
+#define LFSR_R2_LEN 22
+#define LFSR_R3_LEN 23
+#define LFSR_R4_LEN 17
+#define LFSR_R1_FP  0xE4000u
+#define LFSR_R2_FP  0x622000u
+#define LFSR_R3_FP  0xCC0000u
+#define LFSR_R4_FP  0x26200u
+
+typedef struct {
+    uint32_t R1, R2, R3, R4;   // bit i = 레지스터 i번째 비트
+} lfsr_u32_state_t;
+
+// clock: (reg << 1) 의 하위 len 비트 ⊕ parity((reg << 1) & fp).
+// 탭이 4개뿐이므로 parity 대신 탭을 직접 XOR (fp 의 비트 k = clock 전 비트 k-1)
+static inline uint32_t lfsr_u32_clock_r1(uint32_t r) {   // 0xE4000: 19,18,17,14
+    return ((r << 1) & 0x7FFFFu) | (((r >> 18) ^ (r >> 17) ^ (r >> 16) ^ (r >> 13)) & 1u);
+}
+static inline uint32_t lfsr_u32_clock_r2(uint32_t r) {   // 0x622000: 22,21,17,13
+    return ((r << 1) & 0x3FFFFFu) | (((r >> 21) ^ (r >> 20) ^ (r >> 16) ^ (r >> 12)) & 1u);
+}
+static inline uint32_t lfsr_u32_clock_r3(uint32_t r) {   // 0xCC0000: 23,22,19,18
+    return ((r << 1) & 0x7FFFFFu) | (((r >> 22) ^ (r >> 21) ^ (r >> 18) ^ (r >> 17)) & 1u);
+}
+static inline uint32_t lfsr_u32_clock_r4(uint32_t r) {   // 0x26200: 17,14,13,9
+    return ((r << 1) & 0x1FFFFu) | (((r >> 16) ^ (r >> 13) ^ (r >> 12) ^ (r >> 8)) & 1u);
+}
+
+// mzd 상태(1×19, 1×22, 1×23, 1×17) → word 상태
+void lfsr_state_to_u32(const lfsr_matrix_state_t *state, lfsr_u32_state_t *out);
+
 // ── 상태 초기화 헬퍼 ────────────────────────────────────────────────────
 void lfsr_matrix_initialization(lfsr_matrix_state_t *state);
 void lfsr_matrix_initialization_regs(
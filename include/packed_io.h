@@ -0,0 +1,39 @@
+// File: packed_io.h
+#ifndef PACKED_IO_H
+#define PACKED_IO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <m4ri/m4ri.h>
+
+/*
+ * 데이터 파일 일괄 로더
+ *
+ * data/ 의 *.bin packed 행렬(H.bin, Gt.bin, s.bin, ciphertext.bin)은 행 우선으로 이어 붙인
+ * 비트열이고 바이트 안에서는 MSB-first 입니다 (비트 idx = buf[idx/8] >> (7 - idx%8)).
+ * m4ri 행은 word 안에서 LSB-first (열 c = word c/64 의 bit c%64) 이므로, 바이트 8개를
+ * little-endian 으로 읽은 word 에서 각 바이트의 비트만 뒤집으면 (SWAR 3단계) 그대로 행 word 가
+ * 됩니다. 행 시작이 바이트 경계가 아니면 다음 바이트를 이어 붙여 shift 합니다.
+ */
+
+/**
+ * @brief  파일 전체를 read() 한 번(짧게 읽히면 이어서)으로 읽습니다.
+ * @param  out_bytes  읽은 바이트 수
+ * @return malloc 된 버퍼 (free 는 호출자), 실패 시 NULL
+ */
+uint8_t *packed_read_file(const char *path, size_t *out_bytes);
+
+/**
+ * @brief  MSB-first 비트열 buf 의 bit_off 부터 M->nrows × M->ncols 비트를 M 에 행 단위로 채웁니다.
+ *         M 은 mzd_init 으로 만든 행렬이어야 합니다 (창 아님).
+ * @return 0 성공, -1 buf 가 짧음
+ */
+int mzd_unpack_msb(mzd_t *M, const uint8_t *buf, size_t nbytes, size_t bit_off);
+
+/**
+ * @brief  packed_read_file + mzd_unpack_msb. 파일 크기가 ceil(rows·cols/8) 와 정확히 같아야 합니다.
+ * @return 새 rows×cols 행렬, 실패 시 NULL
+ */
+mzd_t *packed_load_matrix(const char *path, rci_t rows, rci_t cols);
+
+#endif // PACKED_IO_H
@@ -0,0 +1,87 @@
+// File: r4_result.h
+#ifndef R4_RESULT_H
+#define R4_RESULT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "decrypt.h"   // R4_SPACE
+
+/* R4 후보 하나에 대한 판정 결과 (status 배열에 1바이트씩 저장) */
+typedef enum {
+    R4_PENDING = 0,   /* 아직 평가되지 않음 */
+    R4_NONE,          /* invalid도 valid도 아님 */
+    R4_INVALID,       /* is_invalid_r4() == true */
+    R4_VALID          /* is_valid_r4() == true */
+} r4_status_t;
+
+/*
+ * R4 결과 파일 (little-endian)
+ *
+ *   off  size  field
+ *   0    4     magic "R4RS"
+ *   4    2     version (R4_RESULT_VERSION)
+ *   6    2     flags (R4_RESULT_F_*)
+ *   8    4     lo          담당 구간 [lo, hi)
+ *   12   4     hi
+ *   16   4     n_invalid
+ *   20   4     n_valid
+ *   24   8     capture fingerprint (r4_result_fingerprint)
+ *   32   4     CRC32 (fingerprint 8바이트 + body)
+ *   36   ...   body: [F_PARTIAL 이면 완료 bitmap ceil((hi-lo)/8) 바이트, LSB-first]
+ *                     uint16 invalid R4 목록, 이어서 uint16 valid R4 목록 (오름차순)
+ *
+ * 목록에 없는 [lo, hi) 안의 R4는 R4_NONE (partial 파일에서 bitmap이 0이면
+ * R4_PENDING) 으로 간주합니다. 파일은 항상 "<path>.tmp" 에 쓴 뒤 fsync 하고
+ * rename 하므로, 중간에 프로세스가 죽어도 이전 파일이 온전히 남습니다.
+ *
+ * 판정은 캡처(암호문 ⊕ scramble)에 따라 달라지므로, 다른 캡처의 결과를 합치거나
+ * 재개하지 않도록 캡처의 c_j·Ht 15개로 만든 fingerprint 를 함께 기록합니다.
+ * c·Ht 가 같은 두 캡처는 R4 판정도 같으므로 같은 캡처로 봅니다.
+ */
+#define R4_RESULT_MAGIC    "R4RS"
+#define R4_RESULT_VERSION  2
+
+#define R4_RESULT_F_PARTIAL  0x0001   /* checkpoint: 완료 bitmap 포함 */
+
+/**
+ * @brief  캡처 fingerprint: cht[j] = 블록 j 의 (c_j ⊕ s)·Ht 에 대한 64비트 FNV-1a.
+ */
+uint64_t r4_result_fingerprint(const word cht[NUM_BLOCKS]);
+
+/** 전역 캡처(cHt_vecs)의 fingerprint. init_globals_core() 뒤에 호출하세요. */
+uint64_t r4_result_global_fingerprint(void);
+
+/**
+ * @brief  status[lo..hi) 를 결과 파일로 씁니다.
+ * @param  fingerprint  결과를 만든 캡처의 r4_result_fingerprint
+ * @return 0 성공, -1 실패 (구간 안에 R4_PENDING 이 남아 있는 경우 포함)
+ */
+int r4_result_write(const char *path, uint32_t lo, uint32_t hi,
+                    uint64_t fingerprint, const uint8_t *status);
+
+/**
+ * @brief  진행 중인 status[lo..hi) 를 checkpoint(partial) 파일로 씁니다.
+ *         R4_PENDING 항목은 bitmap에서 0으로 남습니다.
+ * @return 0 성공, -1 실패
+ */
+int r4_result_write_checkpoint(const char *path, uint32_t lo, uint32_t hi,
+                               uint64_t fingerprint, const uint8_t *status);
+
+/**
+ * @brief  결과 파일을 읽어 status[lo..hi) 를 채웁니다.
+ *         checkpoint 파일이면 미완료 R4는 R4_PENDING 이 됩니다.
+ * @param  fingerprint  기록된 캡처 fingerprint (NULL 가능)
+ * @param  status  R4_SPACE 크기 배열. 구간 밖 항목은 건드리지 않습니다.
+ * @return 0 성공, -1 실패 (magic/version/CRC 불일치, 구간 밖 R4 등)
+ */
+int r4_result_read(const char *path, uint32_t *lo, uint32_t *hi,
+                   uint64_t *fingerprint, uint8_t *status);
+
+/**
+ * @brief  "i/n" 샤드의 R4 구간을 계산합니다. (n 등분, 나머지는 앞쪽부터 분배)
+ * @return 0 성공, -1 잘못된 i, n
+ */
+int r4_shard_range(uint32_t i, uint32_t n, uint32_t *lo, uint32_t *hi);
+
+#endif // R4_RESULT_H
@@ -0,0 +1,87 @@
+// File: r4_sweep.h
+#ifndef R4_SWEEP_H
+#define R4_SWEEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "decrypt.h"
+#include "error_bits.h"
+#include "r4_result.h"   // r4_status_t
+#include "ctht_cache.h"  // ctht_lru_t
+#include "capture.h"     // capture_batch_t
+
+/* 결과를 R4 오름차순으로 하나씩 전달받는 콜백 (한 번에 한 스레드만 호출) */
+typedef void (*r4_result_fn)(uint16_t r4, r4_status_t status, void *user);
+
+typedef struct {
+    uint32_t     lo, hi;        /* 평가할 구간 [lo, hi), hi <= R4_SPACE */
+    int          nthreads;      /* 워커 수, 0이면 온라인 코어 수 */
+    uint32_t     chunk;         /* 워커가 한 번에 가져가는 R4 개수, 0이면 기본값 */
+    const error_config_list_t *configs;
+    r4_result_fn on_result;     /* NULL 가능 */
+    void        *user;
+
+    /* 주기적 checkpoint (r4_result_write_checkpoint 형식), NULL이면 끔 */
+    const char  *checkpoint_path;
+    unsigned     checkpoint_secs;  /* 0이면 기본값 (R4_SWEEP_CHECKPOINT_SECS) */
+    uint64_t     fingerprint;      /* checkpoint 에 기록할 캡처 (r4_result_global_fingerprint) */
+
+    /* 용량 제한 CtHt 캐시, NULL이면 전역 CtHt_cache[] 사용 */
+    ctht_lru_t  *ctht;
+
+    /* 여러 캡처 일괄 판정, NULL이면 전역 캡처(cHt_vecs) 하나.
+       캡처 c 의 결과는 capture_status[c·R4_SPACE + r4] 에 쓰고, status[r4] 에는
+       r4_capture_summary 요약이 들어갑니다. checkpoint 와 함께 쓸 수 없습니다. */
+    const capture_batch_t *captures;
+    uint8_t     *capture_status;
+} r4_sweep_opts_t;
+
+#define R4_SWEEP_CHECKPOINT_SECS 300
+
+/**
+ * @brief  R4 하나를 판정합니다.
+ *         ctht가 있으면 거기서 CtHt를 pin 해서 쓰고(없으면 계산), NULL이면
+ *         CtHt_cache[R4]를 쓰되 비어 있으면 먼저 계산합니다.
+ * @note   init_globals_core()가 먼저 호출되어 있어야 합니다.
+ */
+r4_status_t r4_classify(uint16_t R4,
+                        const error_config_list_t *configs,
+                        r4_scratch_t *scratch,
+                        ctht_lru_t *ctht);
+
+/**
+ * @brief  R4 하나를 batch 의 모든 캡처에 대해 판정합니다.
+ *         CtHt 와 전체 시스템 소거는 한 번만 하고 캡처끼리 나눠 씁니다.
+ * @param  out  out[c] = 캡처 c 의 결과 (batch->n 개)
+ * @return r4_capture_summary(out)
+ * @note   init_globals_shared()가 먼저 호출되어 있어야 합니다.
+ */
+r4_status_t r4_classify_captures(uint16_t R4,
+                                 const error_config_list_t *configs,
+                                 r4_scratch_t *scratch,
+                                 ctht_lru_t *ctht,
+                                 const capture_batch_t *batch,
+                                 uint8_t *out);
+
+/** 캡처별 결과 요약: 하나라도 VALID 면 VALID, 모두 INVALID 면 INVALID, 나머지는 NONE */
+r4_status_t r4_capture_summary(const uint8_t *st, int n);
+
+/**
+ * @brief  [lo, hi) 구간의 R4를 work-stealing 스레드 풀로 판정합니다.
+ *
+ * 구간은 chunk 단위로 잘려 워커별 deque에 라운드로빈으로 배분되고,
+ * 자기 deque가 비면 가장 많이 남은 워커의 뒤쪽 chunk를 훔쳐 옵니다.
+ * 결과는 status[r4]에 기록되며, on_result는 완료 순서와 무관하게
+ * 항상 R4 오름차순으로 호출됩니다.
+ *
+ * checkpoint_path가 있으면 checkpoint_secs마다, 그리고 끝날 때 한 번
+ * 완료 bitmap과 결과를 원자적으로 기록합니다. 재개할 때는 그 파일을
+ * r4_result_read()로 status에 읽어 들인 뒤 다시 호출하면 됩니다.
+ *
+ * @param  status  R4_SPACE 크기 배열. R4_PENDING이 아닌 항목은 건너뜁니다.
+ * @return 0 성공, -1 실패 (잘못된 구간, 캡처 모드의 checkpoint, 마지막 checkpoint 기록 실패)
+ */
+int r4_sweep_run(const r4_sweep_opts_t *opts, uint8_t *status);
+
+#endif // R4_SWEEP_H
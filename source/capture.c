@@ -0,0 +1,233 @@
+// File: capture.c
+#define _POSIX_C_SOURCE 200809L
+#include "capture.h"
+#include "packed_io.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define CAPTURE_SCRAMBLE_SUFFIX  ".s.bin"
+
+int capture_load_cht(const char *cipher_path, const char *scramble_path,
+                     word cht[NUM_BLOCKS])
+{
+    if (!Ht) {
+        fprintf(stderr, "capture_load_cht: call init_H() first\n");
+        abort();
+    }
+    size_t cbytes, sbytes;
+    uint8_t *cbuf = packed_read_file(cipher_path, &cbytes);
+    if (!cbuf) {
+        perror(cipher_path);
+        return -1;
+    }
+    if (cbytes != (size_t)NUM_BLOCKS * BLOCK_BYTES) {
+        fprintf(stderr, "Error: %s size %zu != expected %d\n",
+                cipher_path, cbytes, NUM_BLOCKS * BLOCK_BYTES);
+        free(cbuf);
+        return -1;
+    }
+    uint8_t *sbuf = packed_read_file(scramble_path, &sbytes);
+    if (!sbuf) {
+        perror(scramble_path);
+        free(cbuf);
+        return -1;
+    }
+    if (sbytes != BLOCK_BYTES) {
+        fprintf(stderr, "Error: %s size %zu != expected %d\n",
+                scramble_path, sbytes, BLOCK_BYTES);
+        free(cbuf);
+        free(sbuf);
+        return -1;
+    }
+
+    // (c ⊕ s)·Ht = 켜진 비트 i 마다 Ht 의 i행 (48열이므로 word 하나) XOR
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        const uint8_t *cj  = cbuf + (size_t)j * BLOCK_BYTES;
+        word           acc = 0;
+        for (int b = 0; b < BLOCK_BYTES; ++b) {
+            for (unsigned v = cj[b] ^ sbuf[b]; v; v &= v - 1) {
+                int i = 8 * b + 7 - __builtin_ctz(v);   // MSB-first
+                acc ^= mzd_row_const(Ht, i)[0];
+            }
+        }
+        cht[j] = acc;
+    }
+    free(cbuf);
+    free(sbuf);
+    return 0;
+}
+
+int capture_list_add(capture_list_t *list, const char *cipher_path, const char *scramble_path) {
+    if (list->n == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 64;
+        char **c = realloc(list->cipher, sizeof(char *) * cap);
+        if (!c) return -1;
+        list->cipher = c;
+        char **s = realloc(list->scramble, sizeof(char *) * cap);
+        if (!s) return -1;
+        list->scramble = s;
+        list->cap = cap;
+    }
+    char *c = strdup(cipher_path);
+    char *s = strdup(scramble_path);
+    if (!c || !s) {
+        free(c);
+        free(s);
+        return -1;
+    }
+    list->cipher[list->n]   = c;
+    list->scramble[list->n] = s;
+    list->n++;
+    return 0;
+}
+
+// 실패한 목록 생성이 앞서 추가한 항목을 남기지 않도록 n 개로 되돌림
+static void capture_list_truncate(capture_list_t *list, size_t n) {
+    while (list->n > n) {
+        list->n--;
+        free(list->cipher[list->n]);
+        free(list->scramble[list->n]);
+    }
+}
+
+int capture_list_from_manifest(capture_list_t *list, const char *path,
+                               const char *default_scramble)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char   line[4096];
+    int    lineno = 0;
+    int    rc = 0;
+    size_t n0 = list->n;
+    while (fgets(line, sizeof line, f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *fields[3] = { NULL };
+        int   nf = 0;
+        for (char *p = line; *p && nf < 3; ) {
+            while (*p && isspace((unsigned char)*p)) *p++ = '\0';
+            if (!*p) break;
+            fields[nf++] = p;
+            while (*p && !isspace((unsigned char)*p)) p++;
+        }
+        if (nf == 0) continue;
+        if (nf > 2) {
+            fprintf(stderr, "%s:%d: expected \"cipher [scramble]\"\n", path, lineno);
+            rc = -1;
+            break;
+        }
+        if (capture_list_add(list, fields[0], nf == 2 ? fields[1] : default_scramble) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+    fclose(f);
+    if (rc != 0) capture_list_truncate(list, n0);
+    return rc;
+}
+
+static bool has_suffix(const char *s, const char *suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+int capture_list_from_dir(capture_list_t *list, const char *dir,
+                          const char *default_scramble)
+{
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return -1;
+    }
+    // 이름순으로 처리하도록 먼저 모음
+    char  **names = NULL;
+    size_t  n = 0, cap = 0;
+    int     rc = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (!has_suffix(e->d_name, ".bin") || has_suffix(e->d_name, CAPTURE_SCRAMBLE_SUFFIX)) continue;
+        if (n == cap) {
+            size_t ncap = cap ? cap * 2 : 64;
+            char **t = realloc(names, sizeof(char *) * ncap);
+            if (!t) { rc = -1; break; }
+            names = t;
+            cap   = ncap;
+        }
+        if (!(names[n] = strdup(e->d_name))) { rc = -1; break; }
+        n++;
+    }
+    closedir(d);
+    if (n) qsort(names, n, sizeof(char *), cmp_str);
+
+    size_t n0 = list->n;
+    for (size_t i = 0; i < n; ++i) {
+        size_t len   = strlen(dir) + strlen(names[i]) + sizeof CAPTURE_SCRAMBLE_SUFFIX + 2;
+        char  *cpath = malloc(len);
+        char  *spath = malloc(len);
+        if (!cpath || !spath) abort();
+        snprintf(cpath, len, "%s/%s", dir, names[i]);
+
+        // 암호문 크기가 아닌 *.bin (H.bin, Gt.bin, zS.bin 등) 은 캡처가 아님
+        struct stat st;
+        if (rc == 0 && stat(cpath, &st) == 0 && S_ISREG(st.st_mode) &&
+            st.st_size == (off_t)NUM_BLOCKS * BLOCK_BYTES) {
+            // foo.bin → foo.s.bin
+            snprintf(spath, len, "%s/%.*s%s", dir, (int)(strlen(names[i]) - 4), names[i],
+                     CAPTURE_SCRAMBLE_SUFFIX);
+            const char *s = stat(spath, &st) == 0 ? spath : default_scramble;
+            if (capture_list_add(list, cpath, s) != 0) rc = -1;
+        }
+        free(cpath);
+        free(spath);
+        free(names[i]);
+    }
+    free(names);
+    if (rc != 0) {
+        fprintf(stderr, "capture_list_from_dir: out of memory reading %s\n", dir);
+        capture_list_truncate(list, n0);
+    }
+    return rc;
+}
+
+void capture_list_free(capture_list_t *list) {
+    for (size_t i = 0; i < list->n; ++i) {
+        free(list->cipher[i]);
+        free(list->scramble[i]);
+    }
+    free(list->cipher);
+    free(list->scramble);
+    memset(list, 0, sizeof *list);
+}
+
+int capture_batch_load(capture_batch_t *batch, const capture_list_t *list,
+                       size_t first, size_t count)
+{
+    if (count > CAPTURE_BATCH_MAX) {
+        fprintf(stderr, "capture_batch_load: %zu captures exceeds %d\n", count, CAPTURE_BATCH_MAX);
+        abort();
+    }
+    int skipped = 0;
+    batch->n = 0;
+    for (size_t i = first; i < first + count && i < list->n; ++i) {
+        if (capture_load_cht(list->cipher[i], list->scramble[i], batch->cht[batch->n]) != 0) {
+            fprintf(stderr, "Skipping capture %s\n", list->cipher[i]);
+            skipped++;
+            continue;
+        }
+        batch->index[batch->n++] = i;
+    }
+    return skipped;
+}
@@ -0,0 +1,368 @@
+// File: ctht_cache.c
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE   // MAP_ANONYMOUS
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ctht_cache.h"
+
+#define CTHT_BOM          0x01020304u
+#define CTHT_CKSUM_SEED   0xcbf29ce484222325ULL
+#define CTHT_CKSUM_PRIME  0x100000001b3ULL
+#define CTHT_WRITE_BATCH  256          // 한 번에 fwrite 하는 R4 개수
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t bom;
+    uint32_t entries;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t words_per_entry;
+    uint64_t payload_offset;
+    uint64_t payload_bytes;
+    uint64_t ht_digest;
+    uint64_t checksum;
+} ctht_file_header_t;
+
+static const uint64_t CTHT_PAYLOAD_BYTES =
+    (uint64_t)R4_SPACE * CTHT_ENTRY_WORDS * sizeof(word);
+
+// word 단위 FNV-1a 변형 (+ 상위 비트를 아래로 섞음)
+static uint64_t ctht_checksum_update(uint64_t h, const word *w, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ w[i]) * CTHT_CKSUM_PRIME;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+uint64_t ctht_ht_digest(const mzd_t *Ht) {
+    uint64_t h = CTHT_CKSUM_SEED;
+    word dims[2] = { (word)Ht->nrows, (word)Ht->ncols };
+    h = ctht_checksum_update(h, dims, 2);
+    for (rci_t r = 0; r < Ht->nrows; ++r) {
+        const word *row = mzd_row((mzd_t *)Ht, r);
+        for (wi_t k = 0; k < Ht->width; ++k) {
+            word w = row[k];
+            if (k == Ht->width - 1) w &= Ht->high_bitmask;
+            h = ctht_checksum_update(h, &w, 1);
+        }
+    }
+    return h;
+}
+
+void ctht_pack_entry(const mzd_t *CtHt, word *dst) {
+    if (CtHt->nrows != CTHT_ROWS || CtHt->ncols != CTHT_COLS) {
+        fprintf(stderr, "ctht_pack_entry: expected %dx%d, got %dx%d\n",
+                CTHT_ROWS, CTHT_COLS, CtHt->nrows, CtHt->ncols);
+        abort();
+    }
+    for (rci_t r = 0; r < CTHT_ROWS; ++r) {
+        dst[r] = mzd_row((mzd_t *)CtHt, r)[0] & CtHt->high_bitmask;
+    }
+}
+
+static void ctht_header_init(ctht_file_header_t *h, const mzd_t *Ht) {
+    memset(h, 0, sizeof *h);
+    memcpy(h->magic, CTHT_FILE_MAGIC, 8);
+    h->version         = CTHT_FILE_VERSION;
+    h->bom             = CTHT_BOM;
+    h->entries         = R4_SPACE;
+    h->rows            = CTHT_ROWS;
+    h->cols            = CTHT_COLS;
+    h->words_per_entry = CTHT_ENTRY_WORDS;
+    h->payload_offset  = CTHT_FILE_PAYLOAD_OFFSET;
+    h->payload_bytes   = CTHT_PAYLOAD_BYTES;
+    h->ht_digest       = ctht_ht_digest(Ht);
+}
+
+int ctht_file_write(const char *path, const mzd_t *Ht,
+                    ctht_fill_fn fill, void *user)
+{
+    size_t plen = strlen(path);
+    char  *tmp  = malloc(plen + 5);
+    word  *buf  = malloc(sizeof(word) * CTHT_ENTRY_WORDS * CTHT_WRITE_BATCH);
+    uint8_t *hdr = calloc(CTHT_FILE_PAYLOAD_OFFSET, 1);
+    if (!tmp || !buf || !hdr) abort();
+    memcpy(tmp, path, plen);
+    memcpy(tmp + plen, ".tmp", 5);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        perror(tmp);
+        free(tmp); free(buf); free(hdr);
+        return -1;
+    }
+
+    // 헤더 자리를 먼저 비워 두고 payload를 쓴 다음 checksum과 함께 채움
+    ctht_file_header_t h;
+    ctht_header_init(&h, Ht);
+    int ok = fwrite(hdr, 1, CTHT_FILE_PAYLOAD_OFFSET, f) == CTHT_FILE_PAYLOAD_OFFSET;
+
+    uint64_t cks = CTHT_CKSUM_SEED;
+    for (uint32_t r4 = 0; ok && r4 < R4_SPACE; r4 += CTHT_WRITE_BATCH) {
+        for (uint32_t k = 0; k < CTHT_WRITE_BATCH; ++k) {
+            fill((uint16_t)(r4 + k), buf + (size_t)k * CTHT_ENTRY_WORDS, user);
+        }
+        size_t n = (size_t)CTHT_ENTRY_WORDS * CTHT_WRITE_BATCH;
+        cks = ctht_checksum_update(cks, buf, n);
+        ok = fwrite(buf, sizeof(word), n, f) == n;
+    }
+    h.checksum = cks;
+    memcpy(hdr, &h, sizeof h);
+
+    ok = ok && fseek(f, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(hdr, 1, sizeof h, f) == sizeof h;
+    ok = ok && fflush(f) == 0;
+    ok = ok && fsync(fileno(f)) == 0;
+    ok &= fclose(f) == 0;
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "ctht_file_write: failed to write %s\n", path);
+        remove(tmp);
+        free(tmp); free(buf); free(hdr);
+        return -1;
+    }
+    free(tmp); free(buf); free(hdr);
+    return 0;
+}
+
+int ctht_file_map(const char *path, const mzd_t *Ht, ctht_map_t *m) {
+    memset(m, 0, sizeof *m);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (uint64_t)st.st_size != CTHT_FILE_PAYLOAD_OFFSET + CTHT_PAYLOAD_BYTES) {
+        fprintf(stderr, "%s: unexpected size\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);   // 매핑은 fd 없이 유지됨
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+
+    ctht_file_header_t h;
+    memcpy(&h, base, sizeof h);
+    const char *why = NULL;
+    if (memcmp(h.magic, CTHT_FILE_MAGIC, 8) != 0)        why = "not a CtHt cache file";
+    else if (h.version != CTHT_FILE_VERSION)              why = "unsupported version";
+    else if (h.bom != CTHT_BOM)                           why = "byte order mismatch";
+    else if (h.entries != R4_SPACE || h.rows != CTHT_ROWS ||
+             h.cols != CTHT_COLS ||
+             h.words_per_entry != CTHT_ENTRY_WORDS ||
+             h.payload_offset != CTHT_FILE_PAYLOAD_OFFSET ||
+             h.payload_bytes != CTHT_PAYLOAD_BYTES)       why = "layout mismatch";
+    else if (h.ht_digest != ctht_ht_digest(Ht))           why = "built for a different H";
+    if (why) {
+        fprintf(stderr, "%s: %s\n", path, why);
+        munmap(base, (size_t)st.st_size);
+        return -1;
+    }
+
+    m->base     = base;
+    m->len      = (size_t)st.st_size;
+    m->payload  = (const word *)((const uint8_t *)base + CTHT_FILE_PAYLOAD_OFFSET);
+    m->checksum = h.checksum;
+    return 0;
+}
+
+int ctht_file_verify(const ctht_map_t *m) {
+    uint64_t cks = ctht_checksum_update(CTHT_CKSUM_SEED, m->payload,
+                                        (size_t)R4_SPACE * CTHT_ENTRY_WORDS);
+    return cks == m->checksum ? 0 : -1;
+}
+
+void ctht_file_unmap(ctht_map_t *m) {
+    if (m->base) munmap(m->base, m->len);
+    memset(m, 0, sizeof *m);
+}
+
+mzd_t *ctht_view_init(const word *entry) {
+    // rowstride 1 인 가상의 부모 위에 m4ri 창(window)을 만들어 헤더만 할당
+    mzd_t parent;
+    memset(&parent, 0, sizeof parent);
+    parent.nrows     = CTHT_ROWS;
+    parent.ncols     = CTHT_COLS;
+    parent.width     = 1;
+    parent.rowstride = 1;
+    parent.data      = (word *)entry;
+    return mzd_init_window(&parent, 0, 0, CTHT_ROWS, CTHT_COLS);
+}
+
+static int ctht_slab_views_init(ctht_slab_t *s) {
+    s->views = malloc(sizeof(mzd_t) * (size_t)s->n);
+    if (!s->views) return -1;
+    // 창 헤더 하나를 만들어 두고 data 포인터만 바꿔 복사
+    mzd_t *tmpl = ctht_view_init(s->data);
+    for (uint32_t i = 0; i < s->n; ++i) {
+        s->views[i]      = *tmpl;
+        s->views[i].data = ctht_slab_entry(s, i);
+    }
+    mzd_free_window(tmpl);
+    return 0;
+}
+
+int ctht_slab_init(ctht_slab_t *s, uint32_t n) {
+    memset(s, 0, sizeof *s);
+    size_t bytes = sizeof(word) * CTHT_ENTRY_WORDS * (size_t)n;
+    void *p = mmap(NULL, bytes ? bytes : 1, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("ctht_slab_init: mmap");
+        return -1;
+    }
+    s->data      = p;
+    s->n         = n;
+    s->owns_data = true;
+    if (ctht_slab_views_init(s) != 0) {
+        ctht_slab_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+int ctht_slab_init_mapped(ctht_slab_t *s, const ctht_map_t *m) {
+    memset(s, 0, sizeof *s);
+    s->data      = (word *)m->payload;
+    s->n         = R4_SPACE;
+    s->owns_data = false;
+    return ctht_slab_views_init(s);
+}
+
+void ctht_slab_free(ctht_slab_t *s) {
+    if (s->owns_data && s->data) {
+        munmap(s->data, sizeof(word) * CTHT_ENTRY_WORDS * (size_t)(s->n ? s->n : 1));
+    }
+    free(s->views);
+    memset(s, 0, sizeof *s);
+}
+
+int ctht_lru_init(ctht_lru_t *c, uint32_t capacity, ctht_fill_fn fill, void *user) {
+    memset(c, 0, sizeof *c);
+    if (capacity == 0 || capacity > R4_SPACE || !fill) {
+        fprintf(stderr, "ctht_lru_init: invalid capacity %u\n", capacity);
+        return -1;
+    }
+    if (ctht_slab_init(&c->slab, capacity) != 0) return -1;
+    c->capacity = capacity;
+    c->slot_of  = malloc(sizeof(int32_t) * R4_SPACE);
+    c->r4_of    = malloc(sizeof(int32_t) * capacity);
+    c->pins     = calloc(capacity, sizeof(uint32_t));
+    c->ref      = calloc(capacity, 1);
+    c->ready    = calloc(capacity, 1);
+    if (!c->slot_of || !c->r4_of || !c->pins || !c->ref || !c->ready) abort();
+    for (uint32_t r4 = 0; r4 < R4_SPACE; ++r4) c->slot_of[r4] = -1;
+    for (uint32_t i = 0; i < capacity; ++i)    c->r4_of[i]   = -1;
+    c->fill = fill;
+    c->user = user;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->changed, NULL);
+    return 0;
+}
+
+void ctht_lru_free(ctht_lru_t *c) {
+    if (!c->capacity) return;
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->changed);
+    ctht_slab_free(&c->slab);
+    free(c->slot_of);
+    free(c->r4_of);
+    free(c->pins);
+    free(c->ref);
+    free(c->ready);
+    memset(c, 0, sizeof *c);
+}
+
+// lock 을 잡은 상태에서: pin 안 된 slot 중 참조 비트가 꺼진 것을 clock 으로 찾음.
+// 한 바퀴 돌며 비트를 끄므로 두 바퀴 안에 찾거나, 모두 pin 이면 -1.
+static int32_t ctht_lru_pick_victim(ctht_lru_t *c) {
+    for (uint32_t step = 0; step < 2 * c->capacity; ++step) {
+        uint32_t s = c->hand;
+        c->hand = (c->hand + 1) % c->capacity;
+        if (c->pins[s]) continue;
+        if (c->ref[s]) {
+            c->ref[s] = 0;
+            continue;
+        }
+        return (int32_t)s;
+    }
+    return -1;
+}
+
+const mzd_t *ctht_lru_acquire(ctht_lru_t *c, uint16_t r4) {
+    pthread_mutex_lock(&c->lock);
+    for (;;) {
+        int32_t s = c->slot_of[r4];
+        if (s >= 0) {
+            if (!c->ready[s]) {
+                // 다른 스레드가 계산 중
+                pthread_cond_wait(&c->changed, &c->lock);
+                continue;
+            }
+            c->pins[s]++;
+            c->ref[s] = 1;
+            c->stats.hits++;
+            pthread_mutex_unlock(&c->lock);
+            return ctht_slab_view(&c->slab, (uint32_t)s);
+        }
+
+        s = ctht_lru_pick_victim(c);
+        if (s < 0) {
+            pthread_cond_wait(&c->changed, &c->lock);
+            continue;
+        }
+        if (c->r4_of[s] >= 0) {
+            c->slot_of[c->r4_of[s]] = -1;
+            c->stats.evictions++;
+        }
+        c->slot_of[r4] = s;
+        c->r4_of[s]    = r4;
+        c->ready[s]    = 0;
+        c->pins[s]     = 1;
+        c->stats.misses++;
+        pthread_mutex_unlock(&c->lock);
+
+        // 잠금 밖에서 계산 (pin 되어 있으므로 교체되지 않음)
+        c->fill(r4, ctht_slab_entry(&c->slab, (uint32_t)s), c->user);
+
+        pthread_mutex_lock(&c->lock);
+        c->ready[s] = 1;
+        c->ref[s]   = 1;
+        pthread_cond_broadcast(&c->changed);
+        pthread_mutex_unlock(&c->lock);
+        return ctht_slab_view(&c->slab, (uint32_t)s);
+    }
+}
+
+void ctht_lru_release(ctht_lru_t *c, uint16_t r4) {
+    pthread_mutex_lock(&c->lock);
+    int32_t s = c->slot_of[r4];
+    if (s < 0 || c->pins[s] == 0) {
+        fprintf(stderr, "ctht_lru_release: R4 %u is not pinned\n", r4);
+        abort();
+    }
+    if (--c->pins[s] == 0) {
+        pthread_cond_broadcast(&c->changed);
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+void ctht_lru_get_stats(ctht_lru_t *c, ctht_lru_stats_t *out) {
+    pthread_mutex_lock(&c->lock);
+    *out = c->stats;
+    pthread_mutex_unlock(&c->lock);
+}
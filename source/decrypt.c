@@ -1,4 +1,7 @@
 #include "decrypt.h"
+#include "ctht_cache.h"
+#include "packed_io.h"
+#include <string.h>
 
 //--------------------------------------------------------
 // 전역변수 정의
@@ -7,12 +10,27 @@ mzd_t *Ht      = NULL;
 mzd_t *CtHt_cache[R4_SPACE] = { NULL };
 mzd_t *c_vecs[NUM_BLOCKS]    = { NULL };
 mzd_t *cHt_vecs[NUM_BLOCKS]  = { NULL };
-mzd_t *V_DIFF_MATS[ZS_ROWS]  = { NULL };
+v_diff_t V_DIFF[V_DIFF_COUNT];
+
+// CtHt_cache[r4] 는 모두 이 slab 안의 뷰를 가리킴 (개별 mzd_init 없음).
+// slab 은 익명 메모리이거나, init_CtHt_cache_from_file() 로 매핑된 파일 payload.
+// 익명 slab 은 처음 쓸 때 잡으므로 LRU 만 쓰는 실행에서는 생기지 않습니다.
+static ctht_slab_t     ctht_slab;
+static ctht_map_t      ctht_mapping;
+static pthread_mutex_t ctht_slab_lock = PTHREAD_MUTEX_INITIALIZER;
 
 // 실제 LUT를 채우는 내부 함수
 static uint8_t cross3_LUT[8][8];
 static bool    cross3_ready = false;
 static bool cache_inited = false;
+static inline void ensure_cross3_LUT(void);
+
+// 레지스터별 초기 L의 탭 위치: 열 0..2 = majority 탭, 열 3 = L4 탭
+static const uint8_t lseg_taps[3][4] = {
+    {  1,  6, 15, 11 },   // R1
+    {  3,  8, 14,  1 },   // R2
+    {  4, 15, 19,  0 },   // R3
+};
 
 static void get_Ct_for_r4(uint32_t r4_index, mzd_t* Ct) {
     if (Ct == NULL) {
@@ -65,17 +83,28 @@ void free_cHt_vecs(void) {
         }
     }
 }
+// slab 이 없으면 R4_SPACE 항목짜리를 잡음. sweep 워커가 init_CtHt_for_r4 로
+// 동시에 부를 수 있으므로 lock 안에서 한 번만 만듦
+static void ensure_CtHt_slab(void) {
+    pthread_mutex_lock(&ctht_slab_lock);
+    if (!ctht_slab.data && ctht_slab_init(&ctht_slab, R4_SPACE) != 0) abort();
+    pthread_mutex_unlock(&ctht_slab_lock);
+}
+
+// slab 항목 R4에 CtHt를 바로 계산해 넣고 CtHt_cache[R4] 에 뷰를 연결
+static void fill_CtHt_slab_entry(uint16_t R4) {
+    build_CtHt_words_for_r4(R4, ctht_slab_entry(&ctht_slab, R4));
+    CtHt_cache[R4] = ctht_slab_view(&ctht_slab, R4);
+}
+
 void init_CtHt_cache(void) {
     if (CtHt_cache[0]) return;  // already done
+    ensure_CtHt_slab();
     printf("Building %u CtHt matrices: 0%%", R4_SPACE);
     fflush(stdout);
     for (uint32_t r4 = 0; r4 < R4_SPACE; r4++) {
-        mzd_t *Ct = mzd_init(TOTAL_VARS, C_ROWS);
-        get_Ct_for_r4(r4,Ct);           // 656×208
-        CtHt_cache[r4] = mzd_init(TOTAL_VARS, Ht->ncols); // 656×48
-        mzd_mul(CtHt_cache[r4], Ct, Ht, 0);
-        mzd_free(Ct);
-                // 1 000단위로 진행률 업데이트
+        if (!CtHt_cache[r4]) fill_CtHt_slab_entry(r4);
+                // 1 000단위로 진행률 업데이트
         if ((r4 & 0x3FF) == 0) {
             int pct = (int)(100.0 * r4 / R4_SPACE);
             printf("\rBuilding %u CtHt matrices: %3d%%", R4_SPACE, pct);
@@ -84,13 +113,33 @@ void init_CtHt_cache(void) {
     }
         printf("\rBuilding %u CtHt matrices: 100%%\n", R4_SPACE);
 }
+
+int init_CtHt_cache_from_file(const char *path) {
+    if (ctht_mapping.base) return 0;  // already mapped
+    if (!Ht) {
+        fprintf(stderr, "init_CtHt_cache_from_file: call init_H() first\n");
+        abort();
+    }
+    ctht_map_t m;
+    if (ctht_file_map(path, Ht, &m) != 0) return -1;
+    // 파일에 전부 있으므로 이미 계산된 항목이 있던 익명 slab 은 버림
+    free_CtHt_cache();
+    ctht_mapping = m;
+    if (ctht_slab_init_mapped(&ctht_slab, &ctht_mapping) != 0) abort();
+    for (uint32_t r4 = 0; r4 < R4_SPACE; r4++) {
+        CtHt_cache[r4] = ctht_slab_view(&ctht_slab, r4);
+    }
+    printf("Mapped %u CtHt matrices from %s\n", R4_SPACE, path);
+    return 0;
+}
+
 void free_CtHt_cache(void) {
+    // 뷰는 slab 소유이므로 포인터만 지움
     for (uint32_t r4 = 0; r4 < R4_SPACE; r4++) {
-        if (CtHt_cache[r4]) {
-            mzd_free(CtHt_cache[r4]);
-            CtHt_cache[r4] = NULL;
-        }
+        CtHt_cache[r4] = NULL;
     }
+    ctht_slab_free(&ctht_slab);
+    ctht_file_unmap(&ctht_mapping);
 }
 void init_globals(void) {
     // 1) init_clock_patterns() 호출
@@ -113,43 +162,77 @@ void init_globals(void) {
 
 
 
-void init_globals_for_r4(uint16_t R4) {
+void init_globals_shared(void) {
+    static bool shared_inited = false;
+    if (shared_inited) return;
+    // 공통으로 한번만 해 주어야 할 것들 (캡처와 무관)
+    // 1) init_clock_patterns() 호출
+    init_clock_patterns();
+    // 2) LFSR companion & zS 행렬 캐시
+    printf("Initializing LFSR matrices\n");
+    lfsr_matrices_init();
+    // 3) 패리티 행렬 H, Ht
+    printf("Initializing H and Ht matrices\n");
+    init_H();
+    // 4) v‑difference matrices
+    printf("Initializing v-difference matrices\n");
+    init_v_diff_matrices();
+    // 5) cross3 LUT: 워커 스레드에서 지연 초기화되지 않도록 미리 채움
+    ensure_cross3_LUT();
+    // CtHt slab 은 init_CtHt_for_r4 / init_CtHt_cache 가 처음 쓸 때 잡음
+    shared_inited = true;
+}
+
+void init_globals_core(void) {
     static bool core_inited = false;
-    if (!core_inited) {
-        // 공통으로 한번만 해 주어야 할 것들
-        // 1) init_clock_patterns() 호출
-        init_clock_patterns();
-        // 2) LFSR companion & zS 행렬 캐시
-        printf("Initializing LFSR matrices\n");
-        lfsr_matrices_init();
-        // 3) 패리티 행렬 H, Ht
-        printf("Initializing H and Ht matrices\n");
-        init_H();
-        // 4) Ct × Ht 캐시 (R4_SPACE 개)
-        printf("Initializing CtHt_cache for R4=%u\n", R4);
-        // 5) ciphertext vectors → c_vecs 에 로드된 뒤
-        init_c_vecs();  
-        // 6) cHt_vecs 초기화
-        printf("Initializing cHt_vecs for R4=%u\n", R4);
-        init_cHt_vecs();
-        // 7) v‑difference matrices 
-        printf("Initializing v-difference matrices\n");
-        init_v_diff_matrices();
-        core_inited = true;
+    if (core_inited) return;
+    init_globals_shared();
+    // ciphertext vectors → c_vecs 에 로드된 뒤 cHt_vecs 초기화
+    init_c_vecs();
+    printf("Initializing cHt_vecs\n");
+    init_cHt_vecs();
+    core_inited = true;
+}
+
+void build_CtHt_for_r4(uint16_t R4, mzd_t *CtHt) {
+    // CtHt = Cᵀ·Ht for this R4 (48열이므로 행 하나가 word 하나)
+    word buf[TOTAL_VARS];
+    build_CtHt_words_for_r4(R4, buf);
+    for (int v = 0; v < TOTAL_VARS; ++v) {
+        mzd_row(CtHt, v)[0] = buf[v];
     }
+}
 
+void build_CtHt_for_r4_ref(uint16_t R4, mzd_t *CtHt) {
+    // C 생성 → 전치 → mzd_mul_naive (원본 경로)
+    mzd_t *Ct = mzd_init(TOTAL_VARS, C_ROWS);
+    get_Ct_for_r4(R4, Ct);           // 656×208
+    mzd_mul_naive(CtHt, Ct, Ht);
+    mzd_free(Ct);
+}
+
+void CtHt_fill_entry(uint16_t R4, word *dst, void *user) {
+    (void)user;
+    build_CtHt_words_for_r4(R4, dst);
+}
+
+void init_CtHt_for_r4(uint16_t R4) {
     // R4별로 캐시되는 CtHt_cache[R4] 만 초기화
     // (원래 init_CtHt_cache()가 전부를 순회하던 부분)
     // 여기는 단 하나의 R4에 대해서만 compute
-    if (CtHt_cache[R4] == NULL) {
-        // CtHt_cache[R4] = Hᵀ·Cᵀ for this R4
-        // 먼저 Cᵀ for this R4: (Cᵀ = load or compute from c_vecs & R4)
-        mzd_t *Ct = mzd_init(TOTAL_VARS, C_ROWS);
-        get_Ct_for_r4(R4,Ct);           // 656×208
-        CtHt_cache[R4] = mzd_init(TOTAL_VARS, Ht->ncols); // 656×48
-        mzd_mul_naive(CtHt_cache[R4], Ct, Ht);  
-        mzd_free(Ct);
+    if (CtHt_cache[R4] != NULL) return;
+    ensure_CtHt_slab();
+    if (!ctht_slab.owns_data) {
+        // 매핑된 캐시 파일은 모든 항목이 채워져 있고 읽기 전용
+        fprintf(stderr, "init_CtHt_for_r4: R4 %u missing from mapped CtHt cache\n", R4);
+        abort();
     }
+    fill_CtHt_slab_entry(R4);
+}
+
+void init_globals_for_r4(uint16_t R4) {
+    init_globals_core();
+    init_CtHt_for_r4(R4);
 }
 
 /**
@@ -184,15 +267,7 @@ void init_H(void) {
 
     // H (48×208) 언패킹
     H = mzd_init(48, 208);
-    for (int r = 0; r < 48; r++) {
-        for (int c = 0; c < 208; c++) {
-            size_t idx    = (size_t)r * 208 + c;
-            size_t byte_i = idx >> 3;
-            int    bit_i  = 7 - (idx & 7);
-            int    bit    = (buf[byte_i] >> bit_i) & 1;
-            mzd_write_bit(H, r, c, bit);
-        }
-    }
+    mzd_unpack_msb(H, buf, bytes, 0);
     free(buf);
 
     // Ht = H^T (208×48)
@@ -280,97 +355,184 @@ static inline int quad_index(const LSegment* seg, int u, int v) {
 
 
 
+// 세그먼트 하나의 off-diagonal 칸 (행, 열) 을 rc 에 추가.
+// v 의 1차항 v_u 는 v_u ⊕ d_u 로, 2차항 v_u v_v 는 (v_u ⊕ d_u)(v_v ⊕ d_v) 로 바뀌므로
+//   상수(row 0) → 1차항 열: d_j,   상수 → 2차항 열: d_u d_v
+//   1차항 u 행 → 2차항 (u,v) 열: d_v,   1차항 v 행 → 2차항 (u,v) 열: d_u
+static int v_diff_add_segment(uint16_t (*rc)[2], int n, const mzd_t *zS, int row,
+                              uint16_t var_offset, uint16_t var_len, uint8_t r)
+{
+    LSegment seg;
+    init_LSegment(&seg, var_offset, var_len, r);
+    for (int j = 1; j < seg.reg_len; ++j) {
+        if (mzd_read_bit(zS, row, j)) {
+            rc[n][0] = 0;
+            rc[n][1] = (uint16_t)linear_index(&seg, j);
+            n++;
+        }
+    }
+    for (int u = 1; u < seg.reg_len; ++u) {
+        int du = mzd_read_bit(zS, row, u);
+        for (int v = u + 1; v < seg.reg_len; ++v) {
+            int dv = mzd_read_bit(zS, row, v);
+            uint16_t k = (uint16_t)quad_index(&seg, u, v);
+            if (du & dv) { rc[n][0] = 0;                                rc[n][1] = k; n++; }
+            if (dv)      { rc[n][0] = (uint16_t)linear_index(&seg, u); rc[n][1] = k; n++; }
+            if (du)      { rc[n][0] = (uint16_t)linear_index(&seg, v); rc[n][1] = k; n++; }
+        }
+    }
+    free_LSegment(&seg);
+    return n;
+}
+
 void init_v_diff_matrices(void) {
-    if (V_DIFF_MATS[0]) return;     // 이미 초기화됨
+    if (V_DIFF[0].rows) return;     // 이미 초기화됨
 
     // 1) zS 및 companion matrices 초기화
     lfsr_matrices_init();
 
-    // 2) 각 블럭 i=1..V_DIFF_COUNT에 대해 변환행렬 구축
+    // 2) 각 블럭 i=1..V_DIFF_COUNT에 대해 off-diagonal 칸을 모아 행별(CSR)로 정리
+    //    칸 하나는 많아야 한 번 나오므로 (행, 열) 이 겹치지 않습니다.
+    uint16_t (*rc)[2] = malloc(sizeof(*rc) * V_DIFF_MAX_NNZ);
+    if (!rc) abort();
     for (int i = 1; i <= V_DIFF_COUNT; ++i) {
         int row = i - 1;  // zS 행 인덱스
-
-        // 2.1) 단위행렬 생성 (656×656)
-        mzd_t *M = mzd_init(V_DIFF_SIZE, V_DIFF_SIZE);
-        // identity 설정
-        for (int d = 0; d < V_DIFF_SIZE; ++d) {
-            mzd_write_bit(M, d, d, 1);
-        }
-
-        // R1 segment
-        LSegment seg1;
-        init_LSegment(&seg1, VAR_OFF_R1, VAR_LEN_R1, 1);
-        for (int j = 1; j < seg1.reg_len; ++j) {
-            int li = linear_index(&seg1, j);
-            int dj = mzd_read_bit(zS_R1, row, j);
-            mzd_write_bit(M, 0, li, dj);
-        }
-        for (int u = 1; u < seg1.reg_len; ++u) {
-            int du = mzd_read_bit(zS_R1, row, u);
-            for (int v = u + 1; v < seg1.reg_len; ++v) {
-                int dv = mzd_read_bit(zS_R1, row, v);
-                int k  = quad_index(&seg1, u, v);
-                int lu = linear_index(&seg1, u);
-                int lv = linear_index(&seg1, v);
-                mzd_write_bit(M, 0, k,    du & dv);
-                mzd_write_bit(M, lu, k,   dv);
-                mzd_write_bit(M, lv, k,   du);
+        int nnz = 0;
+        nnz = v_diff_add_segment(rc, nnz, zS_R1, row, VAR_OFF_R1, VAR_LEN_R1, 1);
+        nnz = v_diff_add_segment(rc, nnz, zS_R2, row, VAR_OFF_R2, VAR_LEN_R2, 2);
+        nnz = v_diff_add_segment(rc, nnz, zS_R3, row, VAR_OFF_R3, VAR_LEN_R3, 3);
+
+        // 행별 개수 → 누적 → 채우기 (counting sort)
+        uint32_t count[V_DIFF_SIZE + 1] = {0};
+        for (int t = 0; t < nnz; ++t) count[rc[t][0] + 1]++;
+        v_diff_t *D = &V_DIFF[row];
+        D->nrows = 0;
+        for (int r = 0; r < V_DIFF_SIZE; ++r) D->nrows += count[r + 1] != 0;
+        D->rows  = malloc(sizeof(uint16_t) * (D->nrows ? D->nrows : 1));
+        D->start = malloc(sizeof(uint32_t) * (D->nrows + 1));
+        D->cols  = malloc(sizeof(uint16_t) * (nnz ? nnz : 1));
+        if (!D->rows || !D->start || !D->cols) abort();
+
+        uint32_t pos[V_DIFF_SIZE];
+        int k = 0;
+        D->start[0] = 0;
+        for (int r = 0; r < V_DIFF_SIZE; ++r) {
+            pos[r] = D->start[k];
+            if (count[r + 1]) {
+                D->rows[k]      = (uint16_t)r;
+                D->start[k + 1] = D->start[k] + count[r + 1];
+                k++;
             }
         }
+        for (int t = 0; t < nnz; ++t) D->cols[pos[rc[t][0]]++] = rc[t][1];
+    }
+    free(rc);
+}
 
-        // R2 segment
-        LSegment seg2;
-        init_LSegment(&seg2, VAR_OFF_R2, VAR_LEN_R2, 2);
-        for (int j = 1; j < seg2.reg_len; ++j) {
-            int li = linear_index(&seg2, j);
-            int dj = mzd_read_bit(zS_R2, row, j);
-            mzd_write_bit(M, 0, li, dj);
+void v_diff_mul(mzd_t *dst, int i, const mzd_t *X) {
+    const v_diff_t *D = &V_DIFF[i];
+    if (dst == X || dst->nrows != V_DIFF_SIZE || X->nrows != V_DIFF_SIZE ||
+        dst->ncols != X->ncols) {
+        fprintf(stderr, "v_diff_mul: bad operands (%d×%d ← M · %d×%d)\n",
+                dst->nrows, dst->ncols, X->nrows, X->ncols);
+        abort();
+    }
+
+    // M = I + N: 모든 행이 X 그대로이고, N 이 0 아닌 행에만 X 행들을 XOR
+    mzd_copy(dst, X);
+    const wi_t xw = X->width;
+    for (int k = 0; k < D->nrows; ++k) {
+        word *d = mzd_row(dst, D->rows[k]);
+        for (uint32_t t = D->start[k]; t < D->start[k + 1]; ++t) {
+            const word *x = mzd_row_const(X, D->cols[t]);
+            for (wi_t j = 0; j < xw; ++j) d[j] ^= x[j];
         }
-        for (int u = 1; u < seg2.reg_len; ++u) {
-            int du = mzd_read_bit(zS_R2, row, u);
-            for (int v = u + 1; v < seg2.reg_len; ++v) {
-                int dv = mzd_read_bit(zS_R2, row, v);
-                int k  = quad_index(&seg2, u, v);
-                int lu = linear_index(&seg2, u);
-                int lv = linear_index(&seg2, v);
-                mzd_write_bit(M, 0, k,    du & dv);
-                mzd_write_bit(M, lu, k,   dv);
-                mzd_write_bit(M, lv, k,   du);
-            }
+    }
+}
+
+void v_diff_mul_words(word *dst, int i, const word *X) {
+    const v_diff_t *D = &V_DIFF[i];
+    memcpy(dst, X, sizeof(word) * V_DIFF_SIZE);
+    for (int k = 0; k < D->nrows; ++k) {
+        word acc = 0;
+        for (uint32_t t = D->start[k]; t < D->start[k + 1]; ++t) acc ^= X[D->cols[t]];
+        dst[D->rows[k]] ^= acc;
+    }
+}
+
+void v_diff_apply_vec(mzd_t *dst, int i, const mzd_t *v) {
+    const v_diff_t *D = &V_DIFF[i];
+    if (dst == v || dst->nrows != 1 || v->nrows != 1 ||
+        dst->ncols != V_DIFF_SIZE || v->ncols != V_DIFF_SIZE) {
+        fprintf(stderr, "v_diff_apply_vec: operands must be distinct 1×%d rows\n", V_DIFF_SIZE);
+        abort();
+    }
+
+    // v·M = v ⊕ v·N: v 에서 켜진 행 r 마다 N 의 r 행 열들을 뒤집음
+    mzd_copy(dst, v);
+    word *d = mzd_row(dst, 0);
+    for (int k = 0; k < D->nrows; ++k) {
+        if (!mzd_read_bit(v, 0, D->rows[k])) continue;
+        for (uint32_t t = D->start[k]; t < D->start[k + 1]; ++t) {
+            d[D->cols[t] / m4ri_radix] ^= m4ri_one << (D->cols[t] % m4ri_radix);
         }
+    }
+}
 
-        // R3 segment
-        LSegment seg3;
-        init_LSegment(&seg3, VAR_OFF_R3, VAR_LEN_R3, 3);
-        for (int j = 1; j < seg3.reg_len; ++j) {
-            int li = linear_index(&seg3, j);
-            int dj = mzd_read_bit(zS_R3, row, j);
-            mzd_write_bit(M, 0, li, dj);
+mzd_t *v_diff_to_dense(int i) {
+    const v_diff_t *D = &V_DIFF[i];
+    mzd_t *M = mzd_init(V_DIFF_SIZE, V_DIFF_SIZE);
+    for (int d = 0; d < V_DIFF_SIZE; ++d) {
+        mzd_write_bit(M, d, d, 1);
+    }
+    for (int k = 0; k < D->nrows; ++k) {
+        for (uint32_t t = D->start[k]; t < D->start[k + 1]; ++t) {
+            mzd_write_bit(M, D->rows[k], D->cols[t], 1);
         }
-        for (int u = 1; u < seg3.reg_len; ++u) {
-            int du = mzd_read_bit(zS_R3, row, u);
-            for (int v = u + 1; v < seg3.reg_len; ++v) {
-                int dv = mzd_read_bit(zS_R3, row, v);
-                int k  = quad_index(&seg3, u, v);
-                int lu = linear_index(&seg3, u);
-                int lv = linear_index(&seg3, v);
-                mzd_write_bit(M, 0, k,    du & dv);
-                mzd_write_bit(M, lu, k,   dv);
-                mzd_write_bit(M, lv, k,   du);
-            }
+    }
+    return M;
+}
+
+// v_diff_to_dense_ref: M_{i+1} 을 zS 에서 곧바로 dense 로 쓰는 원본 구현 (CSR 을 거치지 않음)
+static void v_diff_dense_segment_ref(mzd_t *M, const mzd_t *zS, int row,
+                                     uint16_t var_offset, uint16_t var_len, uint8_t r)
+{
+    LSegment seg;
+    init_LSegment(&seg, var_offset, var_len, r);
+    for (int j = 1; j < seg.reg_len; ++j) {
+        mzd_write_bit(M, 0, linear_index(&seg, j), mzd_read_bit(zS, row, j));
+    }
+    for (int u = 1; u < seg.reg_len; ++u) {
+        int du = mzd_read_bit(zS, row, u);
+        for (int v = u + 1; v < seg.reg_len; ++v) {
+            int dv = mzd_read_bit(zS, row, v);
+            int k  = quad_index(&seg, u, v);
+            mzd_write_bit(M, 0, k, du & dv);
+            mzd_write_bit(M, linear_index(&seg, u), k, dv);
+            mzd_write_bit(M, linear_index(&seg, v), k, du);
         }
+    }
+    free_LSegment(&seg);
+}
 
-        // 3) 배열에 저장
-        V_DIFF_MATS[i-1] = M;
+mzd_t *v_diff_to_dense_ref(int i) {
+    lfsr_matrices_init();
+    mzd_t *M = mzd_init(V_DIFF_SIZE, V_DIFF_SIZE);
+    for (int d = 0; d < V_DIFF_SIZE; ++d) {
+        mzd_write_bit(M, d, d, 1);
     }
+    v_diff_dense_segment_ref(M, zS_R1, i, VAR_OFF_R1, VAR_LEN_R1, 1);
+    v_diff_dense_segment_ref(M, zS_R2, i, VAR_OFF_R2, VAR_LEN_R2, 2);
+    v_diff_dense_segment_ref(M, zS_R3, i, VAR_OFF_R3, VAR_LEN_R3, 3);
+    return M;
 }
 
 void free_v_diff_matrices(void) {
     for (int i = 0; i < V_DIFF_COUNT; ++i) {
-        if (V_DIFF_MATS[i]) {
-            mzd_free(V_DIFF_MATS[i]);
-            V_DIFF_MATS[i] = NULL;
-        }
+        free(V_DIFF[i].rows);
+        free(V_DIFF[i].start);
+        free(V_DIFF[i].cols);
+        V_DIFF[i] = (v_diff_t){0};
     }
 }
 
@@ -447,27 +609,11 @@ void init_LSegment(LSegment* seg,
     seg->r          = r;
 
 
-    if (r == 1) {
-        seg->reg_len = 19;
-        seg->L = mzd_init(19, 4);
-        mzd_write_bit(seg->L,  1, 0, 1);
-        mzd_write_bit(seg->L,  6, 1, 1);
-        mzd_write_bit(seg->L, 15, 2, 1);
-        mzd_write_bit(seg->L, 11, 3, 1);
-    } else if (r == 2) {
-        seg->reg_len = 22; 
-        seg->L = mzd_init(22, 4);
-        mzd_write_bit(seg->L,  3, 0, 1);
-        mzd_write_bit(seg->L,  8, 1, 1);
-        mzd_write_bit(seg->L, 14, 2, 1);
-        mzd_write_bit(seg->L,  1, 3, 1);
-    } else {
-        seg->reg_len = 23; 
-        seg->L = mzd_init(23, 4);
-        mzd_write_bit(seg->L,  4, 0, 1);
-        mzd_write_bit(seg->L, 15, 1, 1);
-        mzd_write_bit(seg->L, 19, 2, 1);
-        mzd_write_bit(seg->L,  0, 3, 1);
+    static const uint8_t reg_lens[3] = { 19, 22, 23 };
+    seg->reg_len = reg_lens[r - 1];
+    seg->L = mzd_init(seg->reg_len, 4);
+    for (int k = 0; k < 4; ++k) {
+        mzd_write_bit(seg->L, lseg_taps[r - 1][k], k, 1);
     }
 
     seg->row = mzd_init(1, TOTAL_VARS);
@@ -495,6 +641,22 @@ void update_LSegment(LSegment* seg) {
     mzd_free(tmp);
 }
 
+// update_LSegment_k: L ← A^k × L, A^k 는 lfsr_matrices_init()가 만든 A_pow 표에서 조회
+void update_LSegment_k(LSegment* seg, int k) {
+    if (k == 0) return;
+    if (k < 0 || k > LFSR_POW_MAX || !A_pow[seg->r - 1][k]) {
+        fprintf(stderr, "update_LSegment_k: k=%d out of range or A_pow not initialized\n", k);
+        abort();
+    }
+    // seg->L과 동일 차원 임시 버퍼
+    mzd_t* tmp = mzd_init(seg->L->nrows, seg->L->ncols);
+    // A^k × L 계산
+    mzd_mul(tmp, A_pow[seg->r - 1][k], seg->L, 0);
+    // seg->L에 덮어쓰기
+    mzd_copy(seg->L, tmp);
+    mzd_free(tmp);
+}
+
 
 //------------------------------------------------------------------------------
 // free_LSegment: release L and row
@@ -505,10 +667,10 @@ void free_LSegment(LSegment* seg) {
 }
 
 //------------------------------------------------------------------------------
-// build_linear_system_with_pattern: build C (208×656)
+// build_linear_system_with_pattern_ref: build C (208×656), mzd 기반 원본 구현
 //------------------------------------------------------------------------------
-void build_linear_system_with_pattern(const uint8_t* pattern,
-                                      mzd_t*        C)
+void build_linear_system_with_pattern_ref(const uint8_t* pattern,
+                                          mzd_t*        C)
 {
 
     if (C == NULL) {
@@ -529,6 +691,7 @@ void build_linear_system_with_pattern(const uint8_t* pattern,
 
     // ─────────────────────────────────────────────────
     // 패턴에 따라 LSegment 갱신 및 dbg_y 기록
+    // (검증 기준이므로 DISCARD 구간도 A^k 점프 없이 clock 마다 A 를 곱함)
 for (int i = 0; i < DISCARD + 208; ++i) {
     uint8_t p = pattern[i];
 
@@ -583,6 +746,222 @@ for (int i = 0; i < DISCARD + 208; ++i) {
     free_LSegment(&s3);
 }
 
+//------------------------------------------------------------------------------
+// 워드 단위 빌더
+//------------------------------------------------------------------------------
+// L(reg_len×4)의 각 열을 비트마스크 하나로 보관합니다: bit u = L[u][k].
+// A는 전치 companion 행렬이라 A·x 는 (x >> 1) ^ (x&1 ? fb : 0) 한 번으로 끝납니다.
+typedef struct {
+    uint32_t col[4];      // a, b, c (majority 탭), d (L4 탭)
+    uint32_t fb;          // A의 0번 열
+    int      reg_len;
+    int      var_offset;
+} wl_reg_t;
+
+static void wl_reg_init(wl_reg_t *g, uint8_t r) {
+    const mzd_t *A = (r == 1 ? A1 : r == 2 ? A2 : A3);
+    if (A == NULL) {
+        fprintf(stderr, "build_linear_system_with_pattern: call lfsr_matrices_init() first\n");
+        abort();
+    }
+    g->reg_len    = A->nrows;
+    g->var_offset = (r == 1 ? VAR_OFF_R1 : r == 2 ? VAR_OFF_R2 : VAR_OFF_R3);
+    g->fb = 0;
+    for (int i = 0; i < g->reg_len; ++i) {
+        g->fb |= (uint32_t)mzd_read_bit(A, i, 0) << i;
+    }
+    for (int k = 0; k < 4; ++k) {
+        g->col[k] = 1u << lseg_taps[r - 1][k];
+    }
+}
+
+// L ← A·L
+static inline void wl_reg_clock(wl_reg_t *g) {
+    for (int k = 0; k < 4; ++k) {
+        uint32_t x = g->col[k];
+        g->col[k] = (x >> 1) ^ ((0u - (x & 1u)) & g->fb);
+    }
+}
+
+// row[pos .. pos+n) ^= v (n <= m4ri_radix)
+static inline void wl_xor_bits(word *row, int pos, int n, word v) {
+    int w   = pos / m4ri_radix;
+    int off = pos % m4ri_radix;
+    row[w] ^= v << off;
+    if (off + n > m4ri_radix) {
+        row[w + 1] ^= v >> (m4ri_radix - off);
+    }
+}
+
+// compute_segment_row 과 같은 계수를 row에 XOR 합니다.
+//   cross3(u,v) ^ cross3(v,u) = a_u(b_v^c_v) ^ b_u(c_v^a_v) ^ c_u(a_v^b_v)
+//   cross3(u,u)               = a_u b_u ^ b_u c_u ^ c_u a_u
+// u를 고정하면 v 방향 계수가 비트마스크 하나로 나오고, quad_index(u, u+1..r-1)는
+// 연속이므로 워드 XOR 한두 번으로 기록됩니다.
+static void wl_emit_row(const wl_reg_t *g, word *row) {
+    const int      r = g->reg_len;
+    const uint32_t a = g->col[0], b = g->col[1], c = g->col[2], d = g->col[3];
+    const uint32_t bc = b ^ c, ca = c ^ a, ab = a ^ b;
+    const uint32_t self = (a & b) ^ (b & c) ^ (c & a);
+
+    // 상수항: cross3(t0,t0) ^ L4[0]
+    row[CONSTANT_TERM_INDEX / m4ri_radix] ^=
+        (word)((self ^ d) & 1u) << (CONSTANT_TERM_INDEX % m4ri_radix);
+
+    // 1차항 u=1..r-1 → var_offset + (u-1)
+    uint32_t lin = (a & (0u - (bc & 1u)))
+                 ^ (b & (0u - (ca & 1u)))
+                 ^ (c & (0u - (ab & 1u)))
+                 ^ self ^ d;
+    wl_xor_bits(row, g->var_offset, r - 1, lin >> 1);
+
+    // 2차항 (u<v) → quad_index(u, v)
+    int base = g->var_offset + r - 1;
+    for (int u = 1; u < r - 1; ++u) {
+        uint32_t q = (bc & (0u - ((a >> u) & 1u)))
+                   ^ (ca & (0u - ((b >> u) & 1u)))
+                   ^ (ab & (0u - ((c >> u) & 1u)));
+        int n = r - 1 - u;
+        wl_xor_bits(row, base, n, q >> (u + 1));
+        base += n;
+    }
+}
+
+// C 한 행의 word 수 (656열)
+#define WL_ROW_WORDS ((TOTAL_VARS + m4ri_radix - 1) / m4ri_radix)
+
+// 레지스터 3개를 초기 L로 잡고 DISCARD 구간을 열마다 A^k 한 번으로 건너뜀
+// (k = 그 레지스터의 clock 수)
+static void wl_regs_warm_up(const uint8_t *pattern, wl_reg_t g[3]) {
+    for (int r = 1; r <= 3; ++r) {
+        wl_reg_init(&g[r - 1], (uint8_t)r);
+    }
+    int warm[3];
+    lfsr_count_clocks(pattern, 0, DISCARD, warm);
+    for (int r = 0; r < 3; ++r) {
+        for (int k = 0; k < 4; ++k) {
+            g[r].col[k] = lfsr_pow_apply(r + 1, warm[r], g[r].col[k]);
+        }
+    }
+}
+
+// clock 패턴 p 한 스텝 진행 후 그 시점의 C 행을 row[WL_ROW_WORDS] 에 씀
+static inline void wl_regs_step(wl_reg_t g[3], uint8_t p, word *row) {
+    if (p & 0b100) wl_reg_clock(&g[0]);
+    if (p & 0b010) wl_reg_clock(&g[1]);
+    if (p & 0b001) wl_reg_clock(&g[2]);
+
+    memset(row, 0, sizeof(word) * WL_ROW_WORDS);
+    wl_emit_row(&g[0], row);
+    wl_emit_row(&g[1], row);
+    wl_emit_row(&g[2], row);
+}
+
+//------------------------------------------------------------------------------
+// build_linear_system_with_pattern: build C (208×656), 워드 단위 구현
+//------------------------------------------------------------------------------
+void build_linear_system_with_pattern(const uint8_t* pattern,
+                                      mzd_t*        C)
+{
+    if (C == NULL || C->nrows != C_ROWS || C->ncols != TOTAL_VARS) {
+        fprintf(stderr, "build_linear_system_with_pattern: C must be preallocated %dx%d\n",
+                C_ROWS, TOTAL_VARS);
+        abort();
+    }
+
+    wl_reg_t g[3];
+    wl_regs_warm_up(pattern, g);
+
+    for (int i = DISCARD; i < DISCARD + C_ROWS; ++i) {
+        // 행 전체를 덮어쓰므로 C가 0행렬일 필요는 없음
+        wl_regs_step(g, pattern[i], mzd_row(C, i - DISCARD));
+    }
+}
+
+//------------------------------------------------------------------------------
+// build_CtHt_words_for_r4: CtHt = Cᵀ·Ht 를 C 없이 바로 계산
+//------------------------------------------------------------------------------
+// CtHt[v] = XOR_{i : C[i][v] = 1} Ht[i] 이므로 CtHt 는 키스트림 행 i마다의
+// rank-1 갱신 (C[i]ᵀ · Ht[i]) 의 합입니다. 행을 만들자마자 누적하므로 C(208×656),
+// Cᵀ, 전치가 모두 필요 없습니다.
+// 비트마다 XOR 하는 대신 8행씩 묶어 Ht 8행의 XOR 조합 256개 표를 만들고
+// (m4ri 의 Four Russians 와 같은 방식), 열 v마다 그 8행의 비트 8개로 표를 찾아
+// dst[v] 에 한 번 XOR 합니다. 8행의 비트를 열 단위로 모으는 데는 8×8 비트 전치를 씁니다.
+#define CTHT_GROUP 8
+
+// x의 byte k, bit t 를 byte t, bit k 로 (8×8 비트 행렬 전치)
+static inline uint64_t transpose8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7))  & 0x00AA00AA00AA00AAULL; x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL; x ^= t ^ (t << 28);
+    return x;
+}
+
+// y[k] 의 byte j 를 y[j] 의 byte k 로 (8×8 바이트 행렬 전치)
+static inline void transpose_bytes8x8(uint64_t y[8]) {
+    for (int k = 0; k < 4; ++k) {
+        uint64_t a = y[k], b = y[k + 4];
+        y[k]     = (a & 0x00000000FFFFFFFFULL) | (b << 32);
+        y[k + 4] = (a >> 32) | (b & 0xFFFFFFFF00000000ULL);
+    }
+    for (int k = 0; k < 8; k += (k & 1) ? 3 : 1) {   // (0,2) (1,3) (4,6) (5,7)
+        uint64_t a = y[k], b = y[k + 2];
+        y[k]     = (a & 0x0000FFFF0000FFFFULL) | ((b & 0x0000FFFF0000FFFFULL) << 16);
+        y[k + 2] = ((a >> 16) & 0x0000FFFF0000FFFFULL) | (b & 0xFFFF0000FFFF0000ULL);
+    }
+    for (int k = 0; k < 8; k += 2) {
+        uint64_t a = y[k], b = y[k + 1];
+        y[k]     = (a & 0x00FF00FF00FF00FFULL) | ((b & 0x00FF00FF00FF00FFULL) << 8);
+        y[k + 1] = ((a >> 8) & 0x00FF00FF00FF00FFULL) | (b & 0xFF00FF00FF00FF00ULL);
+    }
+}
+
+void build_CtHt_words_for_r4(uint16_t R4, word *dst)
+{
+    if (Ht == NULL || Ht->nrows != C_ROWS || Ht->ncols > m4ri_radix) {
+        fprintf(stderr, "build_CtHt_words_for_r4: call init_H() first\n");
+        abort();
+    }
+    const uint8_t *pattern = get_clock_pattern(R4);
+
+    wl_reg_t g[3];
+    wl_regs_warm_up(pattern, g);
+
+    memset(dst, 0, sizeof(word) * TOTAL_VARS);
+    word rows[CTHT_GROUP][WL_ROW_WORDS];
+    word table[1 << CTHT_GROUP];
+    table[0] = 0;
+
+    for (int i0 = 0; i0 < C_ROWS; i0 += CTHT_GROUP) {   // C_ROWS = 26 × 8
+        word h[CTHT_GROUP];
+        for (int k = 0; k < CTHT_GROUP; ++k) {
+            wl_regs_step(g, pattern[DISCARD + i0 + k], rows[k]);
+            h[k] = mzd_row_const(Ht, i0 + k)[0];
+        }
+        for (int m = 1; m < (1 << CTHT_GROUP); ++m) {
+            table[m] = table[m & (m - 1)] ^ h[__builtin_ctz(m)];
+        }
+
+        for (int w = 0; w < WL_ROW_WORDS; ++w) {
+            // y[j] 의 byte k = rows[k][w] 의 byte j
+            uint64_t y[CTHT_GROUP];
+            for (int k = 0; k < CTHT_GROUP; ++k) y[k] = rows[k][w];
+            transpose_bytes8x8(y);
+
+            int nbytes = (TOTAL_VARS - w * m4ri_radix) / 8;   // TOTAL_VARS는 8의 배수
+            if (nbytes > 8) nbytes = 8;
+            for (int j = 0; j < nbytes; ++j) {
+                uint64_t x = transpose8x8(y[j]);   // byte t = 열 (w*64 + 8j + t) 의 8행 비트
+                word *out = dst + w * m4ri_radix + 8 * j;
+                for (int t = 0; t < 8; ++t) {
+                    out[t] ^= table[(x >> (8 * t)) & 0xFFu];
+                }
+            }
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 // generate_keystream_via_linear_system
 //------------------------------------------------------------------------------
@@ -665,73 +1044,44 @@ void load_cipher_noscramble_m4ri(
     const char* scramble_path,
     mzd_t*      c_vecs[NUM_BLOCKS]
 ) {
-    // 파일 열기 및 크기 검증
-    FILE* fc = fopen(cipher_path, "rb");
-    if (!fc) { perror(cipher_path); exit(EXIT_FAILURE); }
-    fseek(fc, 0, SEEK_END);
-    long cipher_size = ftell(fc);
+    // 파일 전체를 한 번에 읽고 크기 검증
+    size_t cipher_size, scramble_size;
+    uint8_t* cbuf = packed_read_file(cipher_path, &cipher_size);
+    if (!cbuf) { perror(cipher_path); exit(EXIT_FAILURE); }
     if (cipher_size != NUM_BLOCKS * BLOCK_BYTES) {
         fprintf(stderr,
-                "Error: %s size %ld != expected %d\n",
+                "Error: %s size %zu != expected %d\n",
                 cipher_path, cipher_size, NUM_BLOCKS * BLOCK_BYTES);
         exit(EXIT_FAILURE);
     }
-    fseek(fc, 0, SEEK_SET);
-
-    FILE* fs = fopen(scramble_path, "rb");
-    if (!fs) { perror(scramble_path); exit(EXIT_FAILURE); }
-    fseek(fs, 0, SEEK_END);
-    long scramble_size = ftell(fs);
+    uint8_t* sbuf = packed_read_file(scramble_path, &scramble_size);
+    if (!sbuf) { perror(scramble_path); exit(EXIT_FAILURE); }
     if (scramble_size != BLOCK_BYTES) {
         fprintf(stderr,
-                "Error: %s size %ld != expected %d\n",
+                "Error: %s size %zu != expected %d\n",
                 scramble_path, scramble_size, BLOCK_BYTES);
         exit(EXIT_FAILURE);
     }
-    fseek(fs, 0, SEEK_SET);
 
-    // scramble 벡터 읽기
-    unsigned char s_bytes[BLOCK_BYTES];
-    if (fread(s_bytes, 1, BLOCK_BYTES, fs) != BLOCK_BYTES) {
-        fprintf(stderr, "Error: failed to read %s\n", scramble_path);
-        exit(EXIT_FAILURE);
-    }
-    fclose(fs);
-
-    // 비트 단위로 분해
-    int s_bits[CIPHERTEXT_SIZE];
-    for (int b = 0; b < BLOCK_BYTES; b++) {
-        for (int k = 0; k < 8; k++) {
-            s_bits[b*8 + k] = (s_bytes[b] >> (7 - k)) & 1;
-        }
-    }
+    // scramble 벡터
+    mzd_t* s_vec = mzd_init(1, CIPHERTEXT_SIZE);
+    mzd_unpack_msb(s_vec, sbuf, scramble_size, 0);
+    free(sbuf);
 
-    // 각 블럭에 대해, cipher 읽고 scramble 제거 후 m4ri 벡터에 저장
+    // 각 블럭에 대해, cipher 를 풀고 scramble 제거
     for (int i = 0; i < NUM_BLOCKS; i++) {
-        // 1×CIPHERTEXT_SIZE 벡터 생성
         mzd_t* vec = mzd_init(1, CIPHERTEXT_SIZE);
         if (!vec) {
             fprintf(stderr, "Error: mzd_init failed for block %d\n", i);
             exit(EXIT_FAILURE);
         }
-
-        for (int b = 0; b < BLOCK_BYTES; b++) {
-            unsigned char w;
-            if (fread(&w, 1, 1, fc) != 1) {
-                fprintf(stderr, "Error: failed to read cipher byte %d of block %d\n", b, i);
-                exit(EXIT_FAILURE);
-            }
-            for (int k = 0; k < 8; k++) {
-                int bit = ((w >> (7 - k)) & 1) ^ s_bits[b*8 + k];
-                mzd_write_bit(vec, 0, b*8 + k, bit);
-            }
-        }
-
+        mzd_unpack_msb(vec, cbuf, cipher_size, (size_t)i * CIPHERTEXT_SIZE);
+        mzd_add(vec, vec, s_vec);
         c_vecs[i] = vec;
     }
 
-    fclose(fc);
-
+    mzd_free(s_vec);
+    free(cbuf);
 }
 /**
  * Initialize the c_vecs array with mzd_t structures.
@@ -748,53 +1098,11 @@ void init_c_vecs(void) {
     );
 }
 unsigned char *load_packed_bin(const char *path, size_t *out_bytes) {
-    FILE *f = fopen(path, "rb");
-    if (!f) return NULL;
-    fseek(f, 0, SEEK_END);
-    long sz = ftell(f);
-    rewind(f);
-    unsigned char *buf = malloc(sz);
-    if (!buf) { fclose(f); return NULL; }
-    if (fread(buf,1,sz,f) != (size_t)sz) {
-        free(buf);
-        fclose(f);
-        return NULL;
-    }
-    fclose(f);
-    *out_bytes = (size_t)sz;
-    return buf;
+    return packed_read_file(path, out_bytes);
 }
 
 mzd_t *load_packed_matrix(const char *path, int rows, int cols) {
-    size_t bytes;
-    unsigned char *buf = load_packed_bin(path, &bytes);
-    if (!buf) return NULL;
-
-    size_t expected = ((size_t)rows * cols + 7) / 8;
-    if (bytes != expected) {
-        free(buf);
-        return NULL;
-    }
-
-    mzd_t *M = mzd_init(rows, cols);
-    if (!M) {
-        free(buf);
-        return NULL;
-    }
-
-    // row-major, MSB-first unpack
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c < cols; c++) {
-            size_t idx    = (size_t)r * cols + c;
-            size_t byte_i = idx >> 3;
-            int    bit_i  = 7 - (idx & 7);
-            int    bit    = (buf[byte_i] >> bit_i) & 1;
-            mzd_write_bit(M, r, c, bit);
-        }
-    }
-
-    free(buf);
-    return M;
+    return packed_load_matrix(path, rows, cols);
 }
 
 
@@ -1,4 +1,7 @@
 #include "encrypt.h" //
+#include "encrypt_stream.h"
+#include <string.h>
+#include <pthread.h>
 
 mzd_t *mzd_identity_bit(int n) {
     mzd_t *I = mzd_init(n, n);
@@ -136,39 +139,181 @@ void keystream_generation_with_pattern_m4ri(const lfsr_matrix_state_t* state, co
 
 
 
+void keystream_generation_with_pattern_u32(const lfsr_u32_state_t* state, const uint8_t* pattern,
+                                           word z[KEYSTREAM_WORDS]) {
+    uint32_t R1 = state->R1, R2 = state->R2, R3 = state->R3;
+
+    // pattern 비트는 R4 에 따라 임의로 바뀌므로 분기 대신 mask 로 선택
+#define KS_STEP(p) do {                                                          \
+        uint32_t m1_ = 0u - (uint32_t)(((p) >> 2) & 1);                          \
+        uint32_t m2_ = 0u - (uint32_t)(((p) >> 1) & 1);                          \
+        uint32_t m3_ = 0u - (uint32_t)( (p)       & 1);                          \
+        R1 ^= (R1 ^ lfsr_u32_clock_r1(R1)) & m1_;                                \
+        R2 ^= (R2 ^ lfsr_u32_clock_r2(R2)) & m2_;                                \
+        R3 ^= (R3 ^ lfsr_u32_clock_r3(R3)) & m3_;                                \
+    } while (0)
+
+    // 1) discard 구간: clock 만
+    for (int i = 0; i < DISCARD; i++) {
+        KS_STEP(pattern[i]);
+    }
+
+    // 2) 출력 구간: majority 를 탭 위치만큼 shift 한 word 끼리 계산하고 bit 0 만 씀
+    word acc = 0;
+    for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
+        KS_STEP(pattern[DISCARD + j]);
+
+        uint32_t a1 = R1 >> 1, b1 = R1 >> 6,  c1 = R1 >> 15;
+        uint32_t a2 = R2 >> 3, b2 = R2 >> 8,  c2 = R2 >> 14;
+        uint32_t a3 = R3 >> 4, b3 = R3 >> 15, c3 = R3 >> 19;
+        uint32_t bit = ((a1 & b1) ^ (b1 & c1) ^ (c1 & a1))
+                     ^ ((a2 & b2) ^ (b2 & c2) ^ (c2 & a2))
+                     ^ ((a3 & b3) ^ (b3 & c3) ^ (c3 & a3))
+                     ^ (R1 >> 11) ^ (R2 >> 1) ^ R3;
+        acc |= (word)(bit & 1) << (j % 64);
+        if (j % 64 == 63) {
+            z[j / 64] = acc;
+            acc = 0;
+        }
+    }
+    if (CIPHERTEXT_SIZE % 64) z[KEYSTREAM_WORDS - 1] = acc;
+#undef KS_STEP
+}
+
+// 64×64 비트 행렬 전치: a[r] 의 bit c ↔ a[c] 의 bit r
+static void transpose64(word a[64]) {
+    word m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            word t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k]     ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+// 레지스터 비트 i 를 word 하나에 모음 (bit l = lane l). n 개 lane 외는 0.
+static void bs_pack(word *dst, int len, const uint32_t *src, size_t stride, int n) {
+    for (int i = 0; i < len; i++) dst[i] = 0;
+    for (int l = 0; l < n; l++) {
+        uint32_t r = *(const uint32_t *)((const char *)src + l * stride);
+        for (int i = 0; i < len; i++) {
+            dst[i] |= (word)((r >> i) & 1) << l;
+        }
+    }
+}
+
+// clock mask c 인 lane 만 한 칸 shift 하고 bit 0 에 feedback fb (clock 전 탭의 XOR)
+static inline void bs_clock(word *R, int len, word fb, word c) {
+    for (int i = len - 1; i > 0; i--) {
+        R[i] ^= (R[i] ^ R[i - 1]) & c;
+    }
+    R[0] ^= (R[0] ^ fb) & c;
+}
+
+static inline word bs_maj(word a, word b, word c) {
+    return (a & b) ^ (b & c) ^ (c & a);
+}
+
+void keystream_generation_bs(const lfsr_u32_state_t* states, int n, word z[][KEYSTREAM_WORDS]) {
+    if (n < 0 || n > KS_BS_LANES) {
+        fprintf(stderr, "[bs] lane count %d out of range\n", n);
+        abort();
+    }
+    word R1[LFSR_R1_LEN], R2[LFSR_R2_LEN], R3[LFSR_R3_LEN], R4[LFSR_R4_LEN];
+    bs_pack(R1, LFSR_R1_LEN, &states[0].R1, sizeof *states, n);
+    bs_pack(R2, LFSR_R2_LEN, &states[0].R2, sizeof *states, n);
+    bs_pack(R3, LFSR_R3_LEN, &states[0].R3, sizeof *states, n);
+    bs_pack(R4, LFSR_R4_LEN, &states[0].R4, sizeof *states, n);
+
+    // out[j] 의 bit l = lane l 의 z_j. 64 step 씩 전치해서 lane 별로 돌려줌
+    word out[KEYSTREAM_WORDS][64];
+    memset(out, 0, sizeof out);
+
+    for (int i = 0; i < CLOCK_PATTERN_LEN; i++) {
+        // gen_r4_patterns 와 같은 규칙: majority 와 같은 쪽 레지스터만 clock
+        word m  = bs_maj(R4[1], R4[6], R4[15]);
+        word c1 = ~(m ^ R4[15]);
+        word c2 = ~(m ^ R4[6]);
+        word c3 = ~(m ^ R4[1]);
+        bs_clock(R1, LFSR_R1_LEN, R1[18] ^ R1[17] ^ R1[16] ^ R1[13], c1);
+        bs_clock(R2, LFSR_R2_LEN, R2[21] ^ R2[20] ^ R2[16] ^ R2[12], c2);
+        bs_clock(R3, LFSR_R3_LEN, R3[22] ^ R3[21] ^ R3[18] ^ R3[17], c3);
+        bs_clock(R4, LFSR_R4_LEN, R4[16] ^ R4[13] ^ R4[12] ^ R4[8], ~(word)0);
+
+        if (i >= DISCARD) {
+            int j = i - DISCARD;
+            out[j / 64][j % 64] = bs_maj(R1[1], R1[6], R1[15])
+                                ^ bs_maj(R2[3], R2[8], R2[14])
+                                ^ bs_maj(R3[4], R3[15], R3[19])
+                                ^ R1[11] ^ R2[1] ^ R3[0];
+        }
+    }
+
+    for (int w = 0; w < KEYSTREAM_WORDS; w++) {
+        transpose64(out[w]);
+        for (int l = 0; l < n; l++) {
+            z[l][w] = out[w][l];
+        }
+    }
+}
+
+// --- packed 인코더 ---
+void gt_encoder_init(gt_encoder_t* enc, const int* Gt) {
+    for (int i = 0; i < ENC_PT_BLOCK_BYTES; i++) {
+        // 바이트 비트 b 에 해당하는 Gt 행 (평문 비트 8i + 7 - b)
+        word rows[8][KEYSTREAM_WORDS];
+        memset(rows, 0, sizeof rows);
+        for (int b = 0; b < 8; b++) {
+            int k = i * 8 + 7 - b;
+            for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
+                rows[b][j / 64] |= (word)(Gt[j * PLAINTEXT_BLOCK_SIZE + k] & 1) << (j % 64);
+            }
+        }
+        // v 의 부호어 = (v 에서 최하위 비트를 뺀 값의 부호어) ⊕ 그 비트의 행: 항목당 XOR 한 번
+        word (*tab)[KEYSTREAM_WORDS] = enc->tab[i];
+        memset(tab[0], 0, sizeof tab[0]);
+        for (int v = 1; v < 256; v++) {
+            const word* prev = tab[v & (v - 1)];
+            const word* row  = rows[__builtin_ctz(v)];
+            for (int w = 0; w < KEYSTREAM_WORDS; w++) tab[v][w] = prev[w] ^ row[w];
+        }
+    }
+}
+
+void gt_encode_batch(const gt_encoder_t* enc, const uint8_t* pt, rci_t nblocks, mzd_t* E) {
+    if (E->nrows < nblocks || E->ncols != CIPHERTEXT_SIZE) {
+        fprintf(stderr, "[enc] E is %dx%d, need >=%dx%d\n",
+                E->nrows, E->ncols, nblocks, CIPHERTEXT_SIZE);
+        abort();
+    }
+    // m4ri 행 배치(bit j = 열 j)와 부호어 word 배치가 같으므로 행에 바로 씀
+    for (rci_t r = 0; r < nblocks; r++) {
+        gt_encode_block(enc, pt + (size_t)r * ENC_PT_BLOCK_BYTES, mzd_row(E, r));
+    }
+}
+
 // --- 신뢰 가능한 인코딩 파트: 평문 -> e_all ---
 void encoding_part_m4ri(const char* plaintext, int* e_all, int num_blocks, const int* Gt) {
     encode_plaintext_m4ri(plaintext, e_all, num_blocks, Gt);
 }
 void encode_plaintext_m4ri(const char* plaintext, int* e, int num_blocks, const int* Gt) {
-    // Gt: (CIPHERTEXT_SIZE x PLAINTEXT_BLOCK_SIZE) row-major
-    static mzd_t* Gt_mat = NULL;
-    if (!Gt_mat) {
-        Gt_mat = mzd_init(PLAINTEXT_BLOCK_SIZE, CIPHERTEXT_SIZE);
-        for (int i = 0; i < PLAINTEXT_BLOCK_SIZE; i++) {
-            for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
-                mzd_write_bit(Gt_mat, i, j, Gt[j * PLAINTEXT_BLOCK_SIZE + i]);
-            }
+    // Gt: (CIPHERTEXT_SIZE x PLAINTEXT_BLOCK_SIZE) row-major, 처음 받은 Gt 로 표를 한 번 만듦
+    static gt_encoder_t* enc = NULL;
+    if (!enc) {
+        enc = malloc(sizeof *enc);
+        if (!enc) {
+            fprintf(stderr, "[enc] encoder alloc failed\n");
+            abort();
         }
+        gt_encoder_init(enc, Gt);
     }
     for (int blk = 0; blk < num_blocks; blk++) {
-        // 1. 평문 블록을 m4ri 벡터로 변환
-        mzd_t* p_vec = mzd_init(1, PLAINTEXT_BLOCK_SIZE);
-        for (int i = 0; i < 20; i++) {
-            unsigned char w = (unsigned char)plaintext[blk * 20 + i];
-            for (int k = 0; k < 8; k++) {
-                mzd_write_bit(p_vec, 0, i * 8 + k, (w >> (7 - k)) & 1);
-            }
-        }
-        // 2. e = p * Gt (m4ri 곱셈)
-        mzd_t* e_vec = mzd_init(1, CIPHERTEXT_SIZE);
-        mzd_mul(e_vec, p_vec, Gt_mat, 0);
-        // 3. 결과를 int 배열로 복사
+        word ew[KEYSTREAM_WORDS];
+        gt_encode_block(enc, (const uint8_t*)plaintext + blk * ENC_PT_BLOCK_BYTES, ew);
         for (int i = 0; i < CIPHERTEXT_SIZE; i++) {
-            e[blk * CIPHERTEXT_SIZE + i] = mzd_read_bit(e_vec, 0, i);
+            e[blk * CIPHERTEXT_SIZE + i] = (int)((ew[i / 64] >> (i % 64)) & 1);
         }
-        mzd_free(p_vec);
-        mzd_free(e_vec);
     }
 }
 
@@ -222,15 +367,17 @@ void encrypt_from_state_precise_m4ri(
         // 패턴 조회
         const uint8_t* pattern = get_clock_pattern(r4_index);
 
-        // 키스트림 생성
-        mzd_t* keystream_vec = mzd_init(1, CIPHERTEXT_SIZE);
-        keystream_generation_with_pattern_m4ri(state, pattern, keystream_vec);
+        // 키스트림 생성 (word 레지스터 경로)
+        lfsr_u32_state_t regs;
+        word z[KEYSTREAM_WORDS];
+        lfsr_state_to_u32(state, &regs);
+        keystream_generation_with_pattern_u32(&regs, pattern, z);
 
         // 암호문 벡터 생성
         mzd_t* c_vec = mzd_init(1, CIPHERTEXT_SIZE);
         for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
             int ebit = e_all[i * CIPHERTEXT_SIZE + j];
-            int zbit = mzd_read_bit(keystream_vec, 0, j);
+            int zbit = (int)((z[j / 64] >> (j % 64)) & 1);
             int sbit = s[j];
             mzd_write_bit(c_vec, 0, j, ebit ^ zbit ^ sbit);
         }
@@ -250,9 +397,8 @@ void encrypt_from_state_precise_m4ri(
             c_out[i * CIPHERTEXT_SIZE + j] = mzd_read_bit(c_vec, 0, j);
 
         for (int j = 0; j < CIPHERTEXT_SIZE; j++)
-            z_out[i * CIPHERTEXT_SIZE + j] = mzd_read_bit(keystream_vec, 0, j);
+            z_out[i * CIPHERTEXT_SIZE + j] = (int)((z[j / 64] >> (j % 64)) & 1);
 
-        mzd_free(keystream_vec);
         mzd_free(c_vec);
     }
 
@@ -318,10 +464,10 @@ void expand_states_linearized_m4ri(const lfsr_matrix_state_t* S0, int num, lfsr_
     }
 }
 
-void lfsr_enc_m4ri(
+void lfsr_key_setup_m4ri(
     const int K[KEY_SIZE],
     const int N[NONCE_SIZE],
-    int z[CIPHERTEXT_SIZE]
+    lfsr_u32_state_t* out
 ) {
     // 1) 키·논스 벡터 초기화
     mzd_t* key_vec   = mzd_init(1, KEY_SIZE);
@@ -338,29 +484,11 @@ void lfsr_enc_m4ri(
     bit_reversal_m4ri(a_vec, aa_vec);
 
     // 3) LFSR 상태 초기화 및 키 주입
-    lfsr_matrix_state_t state;
+    lfsr_matrix_state_t state = {0};
     lfsr_matrix_initialization(&state);
     key_injection_m4ri(aa_vec, &state);
+    lfsr_state_to_u32(&state, out);
 
-    // 4) R4 인덱스 계산
-    uint16_t r4_index = 0;
-    for (int k = 1; k < 17; k++)
-        r4_index |= mzd_read_bit(state.R4, 0, k) << (k - 1);
-
-    // 5) 패턴 테이블 초기화·조회
-    init_clock_patterns();
-    const uint8_t* pattern = get_clock_pattern(r4_index);
-
-    // 6) 키스트림 생성
-    mzd_t* z_vec = mzd_init(1, CIPHERTEXT_SIZE);
-    keystream_generation_with_pattern_m4ri(&state, pattern, z_vec);
-
-    // 7) 출력 배열에 비트 복사
-    for (int j = 0; j < CIPHERTEXT_SIZE; j++)
-        z[j] = mzd_read_bit(z_vec, 0, j);
-
-    // 8) 리소스 해제
-    mzd_free(z_vec);
     mzd_free(key_vec);
     mzd_free(nonce_vec);
     mzd_free(a_vec);
@@ -371,67 +499,134 @@ void lfsr_enc_m4ri(
     mzd_free(state.R4);
 }
 
-// m4ri 기반: my_encrypt와 동일한 시그니처의 암호화 함수
-void encrypt_m4ri(const int key[KEY_SIZE], const char* plaintext, int err1, int err2, int err1_bit, int err2_bit, int* ciphertext, const int* s, const int* Gt) {
-    int FN = 9867;
-    int N[NUM_BLOCKS][NONCE_SIZE];
-    int p[NUM_BLOCKS][PLAINTEXT_BLOCK_SIZE];
-    int e[NUM_BLOCKS][CIPHERTEXT_SIZE];
-    int z[NUM_BLOCKS][CIPHERTEXT_SIZE];
-    int c[NUM_BLOCKS][CIPHERTEXT_SIZE];
+// 키 인젝션 응답 표: ks_key_tab[b][v] = 키 바이트 b 가 v 일 때의 상태 기여분 (bit 0 강제 전)
+static lfsr_u32_state_t ks_key_tab[KEY_SIZE / 8][256];
+static lfsr_u32_state_t ks_nonce_tab[(NONCE_SIZE + 7) / 8][256];
+static pthread_once_t   ks_tab_once = PTHREAD_ONCE_INIT;
 
-    // 1. nonce 생성 (my_encrypt와 동일)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        for (int j = 0; j < NONCE_SIZE; j++) {
-            N[i][j] = ((FN + i) >> j) & 1;
-        }
+// key_scheduling_m4ri 에서 nonce 비트 n 이 XOR 되는 a 의 위치
+static int nonce_bit_to_a(int n) {
+    if (n < 4) return n + 60;   // a[60..63] ^= N[0..3]
+    if (n < 6) return n + 18;   // a[22..23] ^= N[4..5]
+    return n - 3;               // a[3..15]  ^= N[6..18]
+}
+
+// 바이트 안 비트마다의 응답으로 256개 조합을 채움
+static void ks_fill_byte_table(lfsr_u32_state_t tab[256], const lfsr_u32_state_t bit_resp[8]) {
+    memset(&tab[0], 0, sizeof tab[0]);
+    for (int v = 1; v < 256; v++) {
+        int k = __builtin_ctz(v);
+        lfsr_u32_state_t t = tab[v & (v - 1)];
+        t.R1 ^= bit_resp[k].R1;
+        t.R2 ^= bit_resp[k].R2;
+        t.R3 ^= bit_resp[k].R3;
+        t.R4 ^= bit_resp[k].R4;
+        tab[v] = t;
     }
+}
 
-    // 2. 평문을 비트로 변환 (my_encrypt와 동일)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        for (int j = 0; j < 20; j++) {
-            unsigned char w = (unsigned char)plaintext[i * 20 + j];
-            for (int k = 0; k < 8; k++) {
-                p[i][j * 8 + k] = (w >> (7 - k)) & 1;
-            }
-        }
+static void ks_tables_build(void) {
+    // aa 비트 k 는 clock 후 bit 0 에 들어가 남은 63-k 번 clock 됨
+    lfsr_u32_state_t aa_resp[KEY_SIZE];
+    lfsr_u32_state_t e = { 1u, 1u, 1u, 1u };
+    for (int k = KEY_SIZE - 1; k >= 0; k--) {
+        aa_resp[k] = e;
+        e.R1 = lfsr_u32_clock_r1(e.R1);
+        e.R2 = lfsr_u32_clock_r2(e.R2);
+        e.R3 = lfsr_u32_clock_r3(e.R3);
+        e.R4 = lfsr_u32_clock_r4(e.R4);
     }
 
-    // 3. e 계산 (my_encrypt와 동일)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
-            e[i][j] = 0;
-            for (int k = 0; k < PLAINTEXT_BLOCK_SIZE; k++) {
-                e[i][j] ^= Gt[j*PLAINTEXT_BLOCK_SIZE + k] & p[i][k];
-            }
+    // a 비트 i → aa 비트 (bit_reversal_m4ri: 16비트 블록 안에서 뒤집기)
+#define A_TO_AA(i) (((i) & ~15) | (15 - ((i) & 15)))
+    for (int b = 0; b < KEY_SIZE / 8; b++) {
+        lfsr_u32_state_t bit_resp[8];
+        for (int k = 0; k < 8; k++) bit_resp[k] = aa_resp[A_TO_AA(b * 8 + k)];
+        ks_fill_byte_table(ks_key_tab[b], bit_resp);
+    }
+    for (int b = 0; b < (NONCE_SIZE + 7) / 8; b++) {
+        lfsr_u32_state_t bit_resp[8];
+        memset(bit_resp, 0, sizeof bit_resp);
+        for (int k = 0; k < 8 && b * 8 + k < NONCE_SIZE; k++) {
+            bit_resp[k] = aa_resp[A_TO_AA(nonce_bit_to_a(b * 8 + k))];
         }
+        ks_fill_byte_table(ks_nonce_tab[b], bit_resp);
     }
+#undef A_TO_AA
+}
 
-    // 4. 각 블록별로 키스트림 생성 (기존 lfsr_enc 함수 재사용)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        lfsr_enc_m4ri(key, N[i], z[i]);
+void lfsr_key_setup(uint64_t K, uint32_t N, lfsr_u32_state_t* out) {
+    pthread_once(&ks_tab_once, ks_tables_build);
+
+    lfsr_u32_state_t s = { 0, 0, 0, 0 };
+    for (int b = 0; b < KEY_SIZE / 8; b++) {
+        const lfsr_u32_state_t *t = &ks_key_tab[b][(K >> (8 * b)) & 0xFF];
+        s.R1 ^= t->R1; s.R2 ^= t->R2; s.R3 ^= t->R3; s.R4 ^= t->R4;
+    }
+    for (int b = 0; b < (NONCE_SIZE + 7) / 8; b++) {
+        const lfsr_u32_state_t *t = &ks_nonce_tab[b][(N >> (8 * b)) & 0xFF];
+        s.R1 ^= t->R1; s.R2 ^= t->R2; s.R3 ^= t->R3; s.R4 ^= t->R4;
     }
+    // key_injection_m4ri 마지막 단계: bit 0 을 1로 강제
+    s.R1 |= 1u; s.R2 |= 1u; s.R3 |= 1u; s.R4 |= 1u;
+    *out = s;
+}
 
-    // 5. 암호문 결합 (my_encrypt와 동일)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
-            c[i][j] = e[i][j] ^ z[i][j] ^ s[j];
-        }
+void lfsr_enc_m4ri(
+    const int K[KEY_SIZE],
+    const int N[NONCE_SIZE],
+    int z[CIPHERTEXT_SIZE]
+) {
+    // 1) 키 스케줄 & 키 주입 (응답 표)
+    uint64_t Kw = 0;
+    uint32_t Nw = 0;
+    for (int i = 0; i < KEY_SIZE; i++)   Kw |= (uint64_t)(K[i] & 1) << i;
+    for (int i = 0; i < NONCE_SIZE; i++) Nw |= (uint32_t)(N[i] & 1) << i;
+    lfsr_u32_state_t regs;
+    lfsr_key_setup(Kw, Nw, &regs);
+
+    // 2) R4 비트 1~16 → 패턴 조회
+    init_clock_patterns();
+    const uint8_t* pattern = get_clock_pattern((uint16_t)(regs.R4 >> 1));
+
+    // 3) 키스트림 생성 (word 레지스터 경로)
+    word zw[KEYSTREAM_WORDS];
+    keystream_generation_with_pattern_u32(&regs, pattern, zw);
+
+    // 4) 출력 배열에 비트 복사
+    for (int j = 0; j < CIPHERTEXT_SIZE; j++)
+        z[j] = (int)((zw[j / 64] >> (j % 64)) & 1);
+}
+
+// m4ri 기반: my_encrypt와 동일한 시그니처의 암호화 함수
+// (FN = 9867 부터 15블록을 encrypt_stream 으로 암호화하고 int 비트로 풀어 줌)
+void encrypt_m4ri(const int key[KEY_SIZE], const char* plaintext, int err1, int err2, int err1_bit, int err2_bit, int* ciphertext, const int* s, const int* Gt) {
+    int FN = 9867;
+
+    // 1. 15블록 평문 → packed 암호문
+    gt_encoder_t* enc = malloc(sizeof *enc);
+    if (!enc) {
+        fprintf(stderr, "[enc] encoder alloc failed\n");
+        abort();
+    }
+    gt_encoder_init(enc, Gt);
+    encrypt_stream_t st;
+    uint8_t ct[NUM_BLOCKS * ENC_CT_BLOCK_BYTES];
+    encrypt_stream_init(&st, key, (uint32_t)FN, s, enc);
+    encrypt_stream_update(&st, (const uint8_t*)plaintext, NUM_BLOCKS * ENC_PT_BLOCK_BYTES, ct);
+    free(enc);
+
+    // 2. 비트로 풀기
+    for (int j = 0; j < NUM_BLOCKS * CIPHERTEXT_SIZE; j++) {
+        ciphertext[j] = (ct[j / 8] >> (7 - j % 8)) & 1;
     }
 
-    // 6. 에러 비트 적용 (my_encrypt와 동일)
+    // 3. 에러 비트 적용 (my_encrypt와 동일)
     if (err1 >= 0 && err1 < NUM_BLOCKS && err1_bit >= 0 && err1_bit < CIPHERTEXT_SIZE)
-        c[err1][err1_bit] ^= 1;
+        ciphertext[err1 * CIPHERTEXT_SIZE + err1_bit] ^= 1;
     if (err2 >= 0 && err2 < NUM_BLOCKS && err2_bit >= 0 && err2_bit < CIPHERTEXT_SIZE)
-        c[err2][err2_bit] ^= 1;
-
-    // 7. 결과를 1차원 배열로 복사 (my_encrypt와 동일)
-    for (int i = 0; i < NUM_BLOCKS; i++) {
-        for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
-            ciphertext[i * CIPHERTEXT_SIZE + j] = c[i][j];
-        }
-    }
-} 
+        ciphertext[err2 * CIPHERTEXT_SIZE + err2_bit] ^= 1;
+}
 
 void generate_keystream_via_clocks( lfsr_matrix_state_t* state,
                                    mzd_t*                     z_vec)
@@ -0,0 +1,93 @@
+// File: encrypt_stream.c
+#include "encrypt_stream.h"
+#include <string.h>
+
+#define NONCE_MASK  ((1u << NONCE_SIZE) - 1)
+
+static inline uint8_t rev8(uint8_t v) {
+    v = (uint8_t)((v & 0xF0) >> 4 | (v & 0x0F) << 4);
+    v = (uint8_t)((v & 0xCC) >> 2 | (v & 0x33) << 2);
+    v = (uint8_t)((v & 0xAA) >> 1 | (v & 0x55) << 1);
+    return v;
+}
+
+void encrypt_stream_init(encrypt_stream_t *st, const int key[KEY_SIZE], uint32_t first_frame,
+                         const int *s, const gt_encoder_t *enc) {
+    memset(st, 0, sizeof *st);
+    for (int i = 0; i < KEY_SIZE; i++) {
+        st->key |= (uint64_t)(key[i] & 1) << i;
+    }
+    st->frame = first_frame;
+    for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
+        st->s[j / 64] |= (word)(s[j] & 1) << (j % 64);
+    }
+    st->enc = enc;
+}
+
+// 다음 frame 의 keystream. 비었으면 앞으로 쓸 블록 수(want, 최대 KS_BS_LANES)만큼 한 번에 만듦
+static const word *stream_next_keystream(encrypt_stream_t *st, size_t want) {
+    if (st->z_next == st->z_count) {
+        int n = want < KS_BS_LANES ? (int)want : KS_BS_LANES;
+        lfsr_u32_state_t regs[KS_BS_LANES];
+        for (int l = 0; l < n; l++) {
+            lfsr_key_setup(st->key, (st->frame + (uint32_t)l) & NONCE_MASK, &regs[l]);
+        }
+        keystream_generation_bs(regs, n, st->z);
+        st->z_count = n;
+        st->z_next  = 0;
+    }
+    return st->z[st->z_next++];
+}
+
+// 평문 블록 하나 → 암호문 블록 하나. blocks_left 는 이 블록을 포함해 바로 처리할 블록 수
+static void stream_block(encrypt_stream_t *st, const uint8_t *pt, size_t blocks_left, uint8_t *ct) {
+    const word *z = stream_next_keystream(st, blocks_left);
+    word c[KEYSTREAM_WORDS];
+    gt_encode_block(st->enc, pt, c);
+    for (int w = 0; w < KEYSTREAM_WORDS; w++) {
+        c[w] ^= z[w] ^ st->s[w];
+    }
+    for (int b = 0; b < ENC_CT_BLOCK_BYTES; b++) {
+        ct[b] = rev8((uint8_t)(c[b / 8] >> (8 * (b % 8))));
+    }
+    st->frame++;
+}
+
+size_t encrypt_stream_update(encrypt_stream_t *st, const uint8_t *in, size_t len, uint8_t *out) {
+    size_t written = 0;
+
+    // 1) 보관 중인 조각부터 채움
+    if (st->npending) {
+        size_t take = ENC_PT_BLOCK_BYTES - st->npending;
+        if (take > len) take = len;
+        memcpy(st->pending + st->npending, in, take);
+        st->npending += take;
+        in  += take;
+        len -= take;
+        if (st->npending < ENC_PT_BLOCK_BYTES) return 0;
+        stream_block(st, st->pending, 1 + len / ENC_PT_BLOCK_BYTES, out);
+        written += ENC_CT_BLOCK_BYTES;
+        st->npending = 0;
+    }
+
+    // 2) 입력 버퍼에서 바로 블록 단위로
+    while (len >= ENC_PT_BLOCK_BYTES) {
+        stream_block(st, in, len / ENC_PT_BLOCK_BYTES, out + written);
+        written += ENC_CT_BLOCK_BYTES;
+        in  += ENC_PT_BLOCK_BYTES;
+        len -= ENC_PT_BLOCK_BYTES;
+    }
+
+    // 3) 나머지는 보관
+    memcpy(st->pending, in, len);
+    st->npending = len;
+    return written;
+}
+
+size_t encrypt_stream_final(encrypt_stream_t *st, uint8_t *out) {
+    if (!st->npending) return 0;
+    memset(st->pending + st->npending, 0, ENC_PT_BLOCK_BYTES - st->npending);
+    stream_block(st, st->pending, 1, out);
+    st->npending = 0;
+    return ENC_CT_BLOCK_BYTES;
+}
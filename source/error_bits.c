@@ -3,14 +3,24 @@
 
 
 
-static void compute_block_syndrome(block_error_t *block);
 #include "error_bits.h"
 #include "m4ri/m4ri.h"
 
+// solver 행 버퍼의 seg번째 블록 자리 [seg*H_ROWS, +H_ROWS) 에 bits 를 XOR
+static inline void row_put_block(word *row, int seg, word bits) {
+    int pos = seg * H_ROWS;
+    int w   = pos / m4ri_radix;
+    int off = pos % m4ri_radix;
+    row[w] ^= bits << off;
+    if (off + H_ROWS > m4ri_radix) {
+        row[w + 1] ^= bits >> (m4ri_radix - off);
+    }
+}
+
 /**
  * @brief   Concatenate all block‐matrices except the one at index `unknown`.
  * @param   A_list    Array of NUM_BLOCKS pointers to mzd_t* (each H_rows×H_cols).
- * @param   unknown   Index to omit (0 … NUM_BLOCKS−1).
+ * @param   unknown   Index to omit (0 … NUM_BLOCKS−1), or −1 to stack all blocks.
  * @param   A_out     Output: pointer to the new concatenated matrix.
  *                    Caller must mzd_free(*A_out).
  */
@@ -42,33 +52,45 @@ void assemble_A_for_unknown(const mzd_t *A_list[NUM_BLOCKS],
 void assemble_system(uint16_t R4,
                      mzd_t *A_list[NUM_BLOCKS],
                      mzd_t *b_list[NUM_BLOCKS]) {
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        A_list[i] = mzd_init(H_ROWS, TOTAL_VARS - 1);  // 48×655
+        b_list[i] = mzd_init(H_ROWS, 1);               // 48×1
+    }
+    assemble_system_into(R4, A_list, b_list);
+}
 
+void assemble_system_into(uint16_t R4,
+                          mzd_t *A_list[NUM_BLOCKS],
+                          mzd_t *b_list[NUM_BLOCKS]) {
     // CtHt_cache[R4]: CtHt is 656×48
-    mzd_t *CtHt = CtHt_cache[R4];
+    assemble_system_from(CtHt_cache[R4], A_list, b_list);
+}
+
+void assemble_system_from(const mzd_t *CtHt_in,
+                          mzd_t *A_list[NUM_BLOCKS],
+                          mzd_t *b_list[NUM_BLOCKS]) {
+    // m4ri 창 API가 const를 받지 않으므로 캐스트만 함 (읽기만 함)
+    mzd_t *CtHt = (mzd_t *)CtHt_in;
 
     for (int i = 0; i < NUM_BLOCKS; ++i) {
         // 1) Build S as 656×48
         mzd_t *S;
         if (i == 0) {
-            // Block 0: S = CtHt
-            S = mzd_copy(NULL, CtHt);
+            // Block 0: S = CtHt (slab 뷰를 복사 없이 그대로 읽음)
+            S = CtHt;
         } else {
-            // Blocks 1…: S = CtHt * V_DIFF_MATS[i-1]
-            //  V_DIFF_MATS[i-1] (48×48)CtHt (656×48) × → 48×656
-            mzd_t *tmp = mzd_init(V_DIFF_MATS[i-1]->nrows, CtHt->ncols);
-            mzd_mul_naive(tmp, V_DIFF_MATS[i-1], CtHt);  
+            // Blocks 1…: S = M_i (656×656, V_DIFF[i-1]) · CtHt (656×48) → 656×48
+            mzd_t *tmp = mzd_init(V_DIFF_SIZE, CtHt->ncols);
+            v_diff_mul(tmp, i - 1, CtHt);
             S = tmp;
         }
 
-        // 2) Extract first row (1×48) into r0
-        mzd_t *r0 = mzd_init(1, S->ncols);  // 1×48
-        for (int c = 0; c < S->ncols; ++c) {
-            mzd_write_bit(r0, 0, c, mzd_read_bit(S, 0, c));
-        }
-
-        mzd_add(r0, r0, cHt_vecs[i]);
+        // 2) r0 = first row of S (1×48) + cHt_i
+        mzd_t *S_row0 = mzd_init_window(S, 0, 0, 1, S->ncols);
+        mzd_t *r0 = mzd_add(NULL, S_row0, cHt_vecs[i]);  // 1×48
+        mzd_free_window(S_row0);
         // 4) b_list[i] = transpose(r0) → 48×1
-        mzd_t *b_i = mzd_transpose(NULL, r0);
+        mzd_transpose(b_list[i], r0);
         mzd_free(r0);
 
         // 5) A_part = rows 1…655 of S → 655×48
@@ -76,160 +98,464 @@ void assemble_system(uint16_t R4,
                                         1, 0,
                                         S->nrows, S->ncols);
         // 6) A_list[i] = transpose(A_part) → 48×655
-        mzd_t *A_i = mzd_transpose(NULL, A_part);
-        mzd_free(A_part);
-
-        // store and clean up
-        A_list[i] = A_i;
-        b_list[i] = b_i;
-        mzd_free(S);
-    }
-}
-/// 호출자는 반환된 리스트를 다 쓰면 free(configs.list) 해야 합니다.
-void generate_error_configs(error_config_list_t *configs){
-    size_t total = NUM_BLOCKS                                  // UNKNOWN_POS 단독
-                 + (size_t)NUM_BLOCKS * (NUM_BLOCKS - 1)      // UNKNOWN+KNOWN 블록 쌍
-                   * CIPHERTEXT_SIZE; // 각 블록에 대해 CIPHERTEXT_SIZE 위치
-    error_bits_t *arr = malloc(sizeof(error_bits_t) * total);
-    size_t idx = 0;
-
-    error_bits_t cfg ;
-    // --- 1) UNKNOWN_POS 단독 ---
-    for (int b1 = 0; b1 < NUM_BLOCKS; ++b1) {
-        memset(&cfg, 0, sizeof(cfg));
-        for (int i = 0; i < NUM_BLOCKS; ++i)
-            cfg.blocks[i].status = BLOCK_NO_ERROR;
-        cfg.blocks[b1].status = BLOCK_ERROR_UNKNOWN_POS;
-        arr[idx++] = cfg;
-        
-    }
-
-    // --- 2) UNKNOWN_POS + KNOWN_POS ---
-    for (int b1 = 0; b1 < NUM_BLOCKS; ++b1) {
-        for (int b2 = 0; b2 < NUM_BLOCKS; ++b2) {
-            if (b2 == b1) continue;
-            for (int pos = 0; pos < CIPHERTEXT_SIZE; ++pos) {
-                memset(&cfg, 0, sizeof(cfg));
-                for (int i = 0; i < NUM_BLOCKS; ++i)
-                    cfg.blocks[i].status = BLOCK_NO_ERROR;
-                cfg.blocks[b1].status         = BLOCK_ERROR_UNKNOWN_POS;
-                cfg.blocks[b2].status         = BLOCK_ERROR_KNOWN_POS;
-                cfg.blocks[b2].error_position = pos;
-                arr[idx++] = cfg;
-            }
+        mzd_transpose(A_list[i], A_part);
+        mzd_free_window(A_part);
+        if (S != CtHt) mzd_free(S);
+    }
+}
+
+// assemble_system_T 에서 캡처와 무관한 부분: b0[j] = S_j[0] (c_j·Ht 를 더하기 전의 우변)
+static void assemble_system_T_base(const mzd_t *CtHt, mzd_t *AT, word b0[NUM_BLOCKS]) {
+    if (AT->nrows != TOTAL_VARS - 1 || AT->ncols != NUM_BLOCKS * H_ROWS) {
+        fprintf(stderr, "assemble_system_T: AT must be %d×%d, got %d×%d\n",
+                TOTAL_VARS - 1, NUM_BLOCKS * H_ROWS, AT->nrows, AT->ncols);
+        abort();
+    }
+    // CtHt 는 48열이므로 행 하나가 word 하나. 블록 j 의 S_j = M_j · CtHt 도 word 배열로 만들고
+    // A_j = (S_j 의 1…655행)ᵀ 이므로 Aᵀ 의 v행, 블록 j 자리 = S_j[v+1] 입니다.
+    const word mask = (m4ri_one << H_ROWS) - 1;
+    word C[TOTAL_VARS], S[TOTAL_VARS];
+    for (rci_t v = 0; v < TOTAL_VARS; ++v) C[v] = mzd_row_const(CtHt, v)[0] & mask;
+
+    mzd_set_ui(AT, 0);
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        const word *Sj = C;
+        if (j > 0) {
+            v_diff_mul_words(S, j - 1, C);
+            Sj = S;
+        }
+        b0[j] = Sj[0] & mask;
+        for (rci_t v = 1; v < TOTAL_VARS; ++v) {
+            row_put_block(mzd_row(AT, v - 1), j, Sj[v]);
         }
     }
+}
 
-    configs->list  = arr;
-    configs->count = idx;
+// 전역 캡처(CIPHERTEXT_PATH)의 c_j·Ht (bit r = 행 r)
+static void global_cht(word cht[NUM_BLOCKS]) {
+    for (int j = 0; j < NUM_BLOCKS; ++j) cht[j] = mzd_row_const(cHt_vecs[j], 0)[0];
 }
 
+void assemble_system_T(const mzd_t *CtHt, mzd_t *AT, word b_bits[NUM_BLOCKS]) {
+    const word mask = (m4ri_one << H_ROWS) - 1;
+    word cht[NUM_BLOCKS];
+    global_cht(cht);
+    assemble_system_T_base(CtHt, AT, b_bits);
+    for (int j = 0; j < NUM_BLOCKS; ++j) b_bits[j] = (b_bits[j] ^ cht[j]) & mask;
+}
+
+void r4_scratch_init(r4_scratch_t *scratch) {
+    scratch->AT    = mzd_init(TOTAL_VARS - 1, NUM_BLOCKS * H_ROWS);
+    scratch->unit  = malloc(sizeof(word) * NUM_BLOCKS * H_ROWS * SOLVER_MAX_ROW_WORDS);
+    scratch->basis = malloc(sizeof(word) * NUM_BLOCKS * H_ROWS * SOLVER_MAX_ROW_WORDS);
+    if (!scratch->unit || !scratch->basis) abort();
+}
 
-void populate_error_config_syndromes(error_config_list_t *configs) {
-    for (size_t i = 0; i < configs->count; ++i) {
-        for (int b = 0; b < NUM_BLOCKS; ++b) {
-            compute_block_syndrome(&configs->list[i].blocks[b]);
+void r4_scratch_free(r4_scratch_t *scratch) {
+    mzd_free(scratch->AT);
+    scratch->AT = NULL;
+    free(scratch->unit);
+    free(scratch->basis);
+    scratch->unit  = NULL;
+    scratch->basis = NULL;
+}
+
+// 행 벡터 XOR basis: basis[k] 는 lead[k] 비트가 켜져 있고 lead[0..k-1] 비트는 0.
+// 그래서 v 를 k = 0, 1, … 순서로 한 번씩만 소거하면 됩니다.
+static void basis_reduce(word *v, const word *basis, const uint16_t *lead,
+                         int n, rci_t width)
+{
+    for (int k = 0; k < n; ++k) {
+        uint16_t l = lead[k];
+        if ((v[l / m4ri_radix] >> (l % m4ri_radix)) & 1) {
+            const word *b = basis + (size_t)k * width;
+            for (rci_t w = 0; w < width; ++w) v[w] ^= b[w];
         }
     }
 }
 
+// v 를 소거해 0이 아니면 basis 끝에 추가
+static void basis_insert(word *basis, uint16_t *lead, int *n,
+                         const word *v, rci_t width)
+{
+    word *dst = basis + (size_t)*n * width;
+    memcpy(dst, v, sizeof(word) * width);
+    basis_reduce(dst, basis, lead, *n, width);
+    for (rci_t w = 0; w < width; ++w) {
+        if (dst[w]) {
+            lead[(*n)++] = (uint16_t)(w * m4ri_radix + __builtin_ctzll(dst[w]));
+            return;
+        }
+    }
+}
 
-/**
- * @brief 단일 block_error_t의 syndrome 벡터를 초기화 및 계산
- * @param block 계산할 block_error_t 포인터
+/*
+ * 블록 j 를 unknown 으로 뺀 시스템 A_{-j}·x = b_{-j} 는 b 가 A_{-j} 의 왼쪽 kernel 과
+ * 직교할 때만 풀립니다. A_{-j} 의 왼쪽 kernel 은 전체 720×655 A 의 왼쪽 kernel 중
+ * 블록 j 자리가 0인 벡터들이므로, unknown 을 바꿀 때마다 다시 소거하지 않고
+ * 전체 A 를 한 번만 소거합니다.
+ *
+ * RREF(Aᵀ) 로 b 를 소거한 reduce(b) 는 비-pivot 좌표에서 (kernel 기저)·b 이고,
+ * unknown 블록의 우변은 아무 값이나 될 수 있으므로
+ *   블록 집합 U 를 뺀 시스템이 풀림 ⇔ U 자리의 어떤 e 에 대해 reduce(b ⊕ e) = 0
+ *                              ⇔ reduce(b) ∈ span{ reduce(e_c) : c ∈ U 블록 자리 }
+ * 입니다. 블록마다 reduce(e_c) 48개와 그 basis 를 한 번 만들어 두면
+ * unknown 한 개/두 개 조합은 모두 이 basis 로 소거하는 것으로 끝납니다.
+ *
+ * A 는 R4 만으로 정해지고 캡처는 b 에만 들어가므로 여기까지는 캡처와 무관합니다.
+ * reduce 도 선형이라 reduce(b) 는 b 의 켜진 비트마다 unit 행 XOR 로 얻습니다 (reduce_rhs).
+ *
+ * scratch->AT 에 assemble_system_T_base 결과가 있어야 합니다.
+ * 반환: scratch->unit / basis / lead / nb 를 채움
  */
-static void compute_block_syndrome(block_error_t *block) {
-    if (block == NULL) {
-        fprintf(stderr, "compute_block_syndrome: block must not be NULL\n");
-        return;
+static void eliminate_all_blocks(r4_scratch_t *scratch) {
+    solver_ctx_t *ctx = solver_prepare_transposed(scratch->AT);   // AT 는 RREF 로 덮어써짐
+    const rci_t width = ctx->width;
+    scratch->width = width;
+
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        word *uj = scratch->unit  + (size_t)j * H_ROWS * width;
+        word *bj = scratch->basis + (size_t)j * H_ROWS * width;
+        scratch->nb[j] = 0;
+        for (int i = 0; i < H_ROWS; ++i) {
+            solver_reduce_bit(ctx, j * H_ROWS + i, uj + (size_t)i * width);
+            basis_insert(bj, scratch->lead[j], &scratch->nb[j], uj + (size_t)i * width, width);
+        }
     }
+    solver_free(ctx);
+}
 
-    if (block->status == BLOCK_ERROR_UNKNOWN_POS ) {
-        if (block->syndrome) {
-            mzd_free(block->syndrome);
-            block->syndrome = NULL;
+void r4_scratch_prepare(const mzd_t *CtHt, r4_scratch_t *scratch) {
+    assemble_system_T_base(CtHt, scratch->AT, scratch->b0);
+    eliminate_all_blocks(scratch);
+}
+
+static bool row_is_zero(const word *v, rci_t width) {
+    word nz = 0;
+    for (rci_t w = 0; w < width; ++w) nz |= v[w];
+    return nz == 0;
+}
+
+// r ← reduce(b), b_j = b0[j] ⊕ cht[j]
+static void reduce_rhs(const r4_scratch_t *scratch, const word cht[NUM_BLOCKS], word *r) {
+    const rci_t width = scratch->width;
+    const word  mask  = (m4ri_one << H_ROWS) - 1;
+    memset(r, 0, sizeof(word) * width);
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        const word *uj = scratch->unit + (size_t)j * H_ROWS * width;
+        for (word e = (scratch->b0[j] ^ cht[j]) & mask; e; e &= e - 1) {
+            const word *u = uj + (size_t)__builtin_ctzll(e) * width;
+            for (rci_t k = 0; k < width; ++k) r[k] ^= u[k];
         }
-        return;
     }
+}
 
-    mzd_t* Global_Parrity_Matrix = NULL;
-    if (H == NULL) {
-        init_H();
+// alive 캡처 중 어떤 두 블록 쌍을 빼면 풀리는 것을 지움.
+// 쌍 basis 는 캡처와 무관하므로 쌍마다 한 번만 합칩니다.
+static word pairs_unsolvable(const r4_scratch_t *scratch, const word *r, word alive) {
+    const rci_t width = scratch->width;
+    word     pair[2 * H_ROWS * SOLVER_MAX_ROW_WORDS];
+    uint16_t plead[2 * H_ROWS];
+    for (int unknown1 = 0; unknown1 < NUM_BLOCKS && alive; ++unknown1) {
+        const word *b1 = scratch->basis + (size_t)unknown1 * H_ROWS * width;
+        for (int unknown2 = unknown1 + 1; unknown2 < NUM_BLOCKS && alive; ++unknown2) {
+            const word *b2 = scratch->basis + (size_t)unknown2 * H_ROWS * width;
+            int np = scratch->nb[unknown1];
+            memcpy(pair, b1, sizeof(word) * width * np);
+            memcpy(plead, scratch->lead[unknown1], sizeof(uint16_t) * np);
+            for (int k = 0; k < scratch->nb[unknown2]; ++k) {
+                basis_insert(pair, plead, &np, b2 + (size_t)k * width, width);
+            }
+
+            for (word m = alive; m; m &= m - 1) {
+                int  c = __builtin_ctzll(m);
+                word t[SOLVER_MAX_ROW_WORDS];
+                memcpy(t, r + (size_t)c * SOLVER_MAX_ROW_WORDS, sizeof(word) * width);
+                basis_reduce(t, pair, plead, np, width);
+                if (row_is_zero(t, width)) alive &= ~(m4ri_one << c);
+            }
+        }
+    }
+    return alive;
+}
+
+// unknown 구간의 설정 중 하나라도 풀리는 캡처를 pending 에서 골라 반환.
+// unknown 블록 basis 로의 소거도 선형이므로, 소거된 b 와 known 블록 단위 비트 48개를
+// 먼저 basis 로 소거해 두면 설정 하나의 이미지는 syndrome 의 켜진 비트마다 행 XOR 이고,
+// 캡처마다는 그 이미지가 자기 base 와 같은지만 보면 됩니다.
+static word scan_configs(const r4_scratch_t *scratch,
+                         const error_config_list_t *configs,
+                         int unknown,
+                         const word *r,    // 캡처 c 의 reduce(b) = r + c·SOLVER_MAX_ROW_WORDS
+                         word pending)
+{
+    const rci_t     width = scratch->width;
+    const word     *basis = scratch->basis + (size_t)unknown * H_ROWS * width;
+    const uint16_t *lead  = scratch->lead[unknown];
+    const int       nb    = scratch->nb[unknown];
+    word            found = 0;
+
+    // known 없는 설정: 기본 b 자체
+    word base[CAPTURE_BATCH_MAX][SOLVER_MAX_ROW_WORDS];
+    for (word m = pending; m; m &= m - 1) {
+        int c = __builtin_ctzll(m);
+        memcpy(base[c], r + (size_t)c * SOLVER_MAX_ROW_WORDS, sizeof(word) * width);
+        basis_reduce(base[c], basis, lead, nb, width);
+        if (row_is_zero(base[c], width)) found |= m4ri_one << c;
+    }
+    pending &= ~found;
+    if (!pending) return found;
+
+    word img[H_ROWS * SOLVER_MAX_ROW_WORDS];   // 현재 known 블록 단위 비트의 소거 결과
+    int  img_block = -1;
+    error_config_t cfg = error_config_at((size_t)unknown * ERROR_CONFIG_SEGMENT);
+    while (pending && error_config_next(&cfg) && cfg.unknown == unknown) {
+        if (cfg.known != img_block) {
+            img_block = cfg.known;
+            memcpy(img, scratch->unit + (size_t)img_block * H_ROWS * width,
+                   sizeof(word) * H_ROWS * width);
+            for (int i = 0; i < H_ROWS; ++i) {
+                basis_reduce(img + (size_t)i * width, basis, lead, nb, width);
+            }
+        }
+        word acc[SOLVER_MAX_ROW_WORDS] = {0};
+        for (word e = error_config_syndrome(configs, &cfg); e; e &= e - 1) {
+            const word *u = img + (size_t)__builtin_ctzll(e) * width;
+            for (rci_t k = 0; k < width; ++k) acc[k] ^= u[k];
+        }
+        for (word m = pending; m; m &= m - 1) {
+            int c = __builtin_ctzll(m);
+            if (memcmp(acc, base[c], sizeof(word) * width) == 0) {
+                found   |= m4ri_one << c;
+                pending &= ~(m4ri_one << c);
+            }
+        }
     }
-    Global_Parrity_Matrix = H;
+    return found;
+}
 
-    if (block->syndrome) {
-        mzd_free(block->syndrome);
+void r4_classify_prepared(const r4_scratch_t *scratch,
+                          const error_config_list_t *configs,
+                          const word (*cht)[NUM_BLOCKS], int n,
+                          word *invalid, word *valid)
+{
+    if (n < 0 || n > CAPTURE_BATCH_MAX) {
+        fprintf(stderr, "r4_classify_prepared: %d captures exceeds %d\n", n, CAPTURE_BATCH_MAX);
+        abort();
     }
-    else {
-        block->syndrome = mzd_init(Global_Parrity_Matrix->nrows, 1);
+    const rci_t width = scratch->width;
+    word pending = n == CAPTURE_BATCH_MAX ? ~(word)0 : (m4ri_one << n) - 1;
+    word ok      = 0;
+
+    // 1) 캡처별 reduce(b). 0이면 어느 설정이든 풀림
+    word r[CAPTURE_BATCH_MAX * SOLVER_MAX_ROW_WORDS];
+    for (int c = 0; c < n; ++c) {
+        word *rc = r + (size_t)c * SOLVER_MAX_ROW_WORDS;
+        reduce_rhs(scratch, cht[c], rc);
+        if (row_is_zero(rc, width)) ok |= m4ri_one << c;
     }
+    pending &= ~ok;
+
+    // 2) 어느 쌍을 빼도 풀리지 않으면 invalid. 쌍은 모든 설정을 포함하므로 valid 일 수 없음
+    word bad = pairs_unsolvable(scratch, r, pending);
+    pending &= ~bad;
 
-    if ( block->status == BLOCK_NO_ERROR){
-        return;
+    // 3) 나머지는 설정을 훑어 valid 여부
+    for (int unknown = 0; unknown < NUM_BLOCKS && pending; ++unknown) {
+        word found = scan_configs(scratch, configs, unknown, r, pending);
+        ok      |= found;
+        pending &= ~found;
     }
-    // BLOCK_ERROR_KNOWN_POS
+    *invalid = bad;
+    *valid   = ok;
+}
 
-    if (block->status != BLOCK_ERROR_KNOWN_POS) {
-        fprintf(stderr, "compute_block_syndrome: invalid block status %d\n", block->status);
-        return;
+bool is_invalid_r4(const mzd_t *CtHt,
+                   const error_config_list_t *configs,
+                   r4_scratch_t *scratch)
+{
+    word cht[1][NUM_BLOCKS], invalid, valid;
+    global_cht(cht[0]);
+    r4_scratch_prepare(CtHt, scratch);
+    r4_classify_prepared(scratch, configs, (const word (*)[NUM_BLOCKS])cht, 1, &invalid, &valid);
+    return invalid & 1;
+}
+
+bool is_valid_r4(const mzd_t *CtHt,
+                 const error_config_list_t *configs,
+                 r4_scratch_t *scratch)
+{
+    word cht[1][NUM_BLOCKS], invalid, valid;
+    global_cht(cht[0]);
+    r4_scratch_prepare(CtHt, scratch);
+    r4_classify_prepared(scratch, configs, (const word (*)[NUM_BLOCKS])cht, 1, &invalid, &valid);
+    return valid & 1;
+}
+void error_configs_init(error_config_list_t *configs) {
+    if (H == NULL) {
+        init_H();
+    }
+    // pos 위치 단일 비트 오류 e_pos 의 syndrome H·e_pos = H의 pos 열
+    for (int pos = 0; pos < CIPHERTEXT_SIZE; ++pos) {
+        word s = 0;
+        for (rci_t r = 0; r < H->nrows; ++r) {
+            s |= (word)mzd_read_bit(H, r, pos) << r;
+        }
+        configs->syndrome[pos] = s;
     }
+    configs->count = ERROR_CONFIG_COUNT;
+}
 
+error_config_t error_config_at(size_t idx) {
+    error_config_t cfg;
+    size_t off  = idx % ERROR_CONFIG_SEGMENT;
+    cfg.unknown = (int8_t)(idx / ERROR_CONFIG_SEGMENT);
+    if (off == 0) {
+        cfg.known = -1;
+        cfg.pos   = 0;
+    } else {
+        int k     = (int)((off - 1) / CIPHERTEXT_SIZE);   // unknown 을 뺀 k번째 블록
+        cfg.known = (int8_t)(k < cfg.unknown ? k : k + 1);
+        cfg.pos   = (uint8_t)((off - 1) % CIPHERTEXT_SIZE);
+    }
+    return cfg;
+}
 
-    if (block->error_position < 0 || block->error_position >= CIPHERTEXT_SIZE) {
-        fprintf(stderr, "compute_block_syndrome: invalid error position %d\n", block->error_position);
-        return;
+bool error_config_next(error_config_t *cfg) {
+    if (cfg->known >= 0 && cfg->pos + 1 < CIPHERTEXT_SIZE) {
+        cfg->pos++;
+        return true;
+    }
+    int next = cfg->known + 1;
+    if (next == cfg->unknown) next++;
+    if (next < NUM_BLOCKS) {
+        cfg->known = (int8_t)next;
+        cfg->pos   = 0;
+        return true;
+    }
+    if (cfg->unknown + 1 < NUM_BLOCKS) {
+        cfg->unknown++;
+        cfg->known = -1;
+        cfg->pos   = 0;
+        return true;
     }
-    mzd_t* e_vec = mzd_init(CIPHERTEXT_SIZE, 1);
-    mzd_write_bit(e_vec, 0, block->error_position, 1);
-    mzd_mul_naive(block->syndrome, Global_Parrity_Matrix, e_vec);
-}   
+    return false;
+}
+
 solver_ctx_t *solver_prepare(const mzd_t *A) {
+    if (A->nrows > SOLVER_MAX_ROWS) {
+        fprintf(stderr, "solver_prepare: %d rows exceeds %d\n", A->nrows, SOLVER_MAX_ROWS);
+        abort();
+    }
+    mzd_t *A_tr = mzd_transpose(NULL, A);     // dims: n×m
+    solver_ctx_t *ctx = solver_prepare_transposed(A_tr);
+    mzd_free(A_tr);
+    return ctx;
+}
+
+solver_ctx_t *solver_prepare_transposed(mzd_t *A_tr) {
+    if (A_tr->ncols > SOLVER_MAX_ROWS) {
+        fprintf(stderr, "solver_prepare: %d rows exceeds %d\n", A_tr->ncols, SOLVER_MAX_ROWS);
+        abort();
+    }
     solver_ctx_t *ctx = malloc(sizeof *ctx);
-    rci_t m = A->nrows, n = A->ncols;
 
-    // 1) Aᵀ 전치 + full RREF
-    ctx->A_tr = mzd_transpose(NULL, A);       // dims: n×m
-    mzd_gauss_delayed(ctx->A_tr, 0, TRUE);    // full Gauss–Jordan
+    // 1) Aᵀ full RREF (제자리)
+    mzd_gauss_delayed(A_tr, 0, TRUE);         // full Gauss–Jordan
 
-    // 2) pivot-columns 추출 (기존 구현 그대로)
+    // 2) pivot 행만 연속 배열로 복사하고 pivot 열을 기록.
+    //    RREF 이므로 0이 아닌 행은 위쪽에 모여 있고, 행의 첫 1이 pivot 열입니다.
+    ctx->m     = A_tr->ncols;
+    ctx->width = A_tr->width;
+    ctx->rows  = malloc(sizeof(word) * (size_t)ctx->width * (size_t)(A_tr->nrows ? A_tr->nrows : 1));
+    if (!ctx->rows) abort();
     ctx->npiv = 0;
-    for (rci_t r = 0; r < ctx->A_tr->nrows; ++r) {
-        for (rci_t c = 0; c < ctx->A_tr->ncols; ++c) {
-            if (mzd_read_bit(ctx->A_tr, r, c)) {
-                ctx->pivots[ctx->npiv++] = (uint32_t)c;
-                break;
-            }
-        }
+    for (rci_t r = 0; r < A_tr->nrows; ++r) {
+        const word *src = mzd_row_const(A_tr, r);
+        rci_t w = 0;
+        while (w < ctx->width && src[w] == 0) w++;
+        if (w == ctx->width) break;
+        ctx->pivots[ctx->npiv] = (uint32_t)(w * m4ri_radix + __builtin_ctzll(src[w]));
+        memcpy(ctx->rows + (size_t)ctx->npiv * ctx->width, src, sizeof(word) * ctx->width);
+        ctx->npiv++;
     }
+
+    // 3) b 좌표 → pivot 행 (solver_reduce_bit 용)
+    for (rci_t c = 0; c < ctx->m; ++c) ctx->pivot_row[c] = -1;
+    for (rci_t i = 0; i < ctx->npiv; ++i) ctx->pivot_row[ctx->pivots[i]] = (int16_t)i;
     return ctx;
 }
 
-bool solver_check(const solver_ctx_t *ctx, const mzd_t *b) {
-    // 3) 기존 구현의 3)~ 끝 부분을 그대로 사용
-    rci_t new_r = ctx->A_tr->nrows;
-    mzd_t *b_row = mzd_transpose(NULL, b);        // 1×m
-    mzd_t *M     = mzd_stack(NULL, ctx->A_tr, b_row); // (n+1)×m
-    mzd_free(b_row);
+void solver_reduce_bit(const solver_ctx_t *ctx, rci_t c, word *out) {
+    // full RREF 이므로 pivot 행은 다른 pivot 열에서 0 → e_c 의 소거는 XOR 한 번
+    int16_t i = ctx->pivot_row[c];
+    if (i >= 0) {
+        memcpy(out, ctx->rows + (size_t)i * ctx->width, sizeof(word) * ctx->width);
+    } else {
+        memset(out, 0, sizeof(word) * ctx->width);
+    }
+    out[c / m4ri_radix] ^= m4ri_one << (c % m4ri_radix);
+}
 
+bool solver_check_row(const solver_ctx_t *ctx, word *row) {
+    // b가 A의 열공간에 있음 ⇔ bᵀ 가 RREF(Aᵀ) 행공간에 있음:
+    // pivot 열의 비트가 켜져 있으면 그 pivot 행을 XOR (pivot 앞쪽 word는 0이므로 건너뜀)
+    const rci_t width = ctx->width;
     for (rci_t i = 0; i < ctx->npiv; ++i) {
-        rci_t col = ctx->pivots[i];
-        if (mzd_read_bit(M, new_r, col)) {
-            mzd_row_add_offset(M, new_r, i, col);
+        uint32_t col = ctx->pivots[i];
+        rci_t    w   = (rci_t)(col / m4ri_radix);
+        if ((row[w] >> (col % m4ri_radix)) & 1) {
+            const word *p = ctx->rows + (size_t)i * width;
+            for (rci_t k = w; k < width; ++k) row[k] ^= p[k];
         }
     }
+    word acc = 0;
+    for (rci_t k = 0; k < width; ++k) acc |= row[k];
+    return acc == 0;
+}
+
+bool solver_check(const solver_ctx_t *ctx, const mzd_t *b) {
+    word row[SOLVER_MAX_ROW_WORDS] = {0};
+    for (rci_t i = 0; i < ctx->m; ++i) {
+        if (mzd_read_bit(b, i, 0)) {
+            row[i / m4ri_radix] |= m4ri_one << (i % m4ri_radix);
+        }
+    }
+    return solver_check_row(ctx, row);
+}
 
-    // original code used mzd_init_window + mzd_is_zero
-    mzd_t *ret = mzd_init_window(M, new_r, 0, new_r + 1, M->ncols);
-    bool solvable = mzd_is_zero(ret);
-    mzd_free_window(ret);
+word solver_check_batch(const solver_ctx_t *ctx, mzd_t *B) {
+    if (B->nrows != ctx->m || B->ncols > m4ri_radix) {
+        fprintf(stderr, "solver_check_batch: B must be %d×(≤%d), got %d×%d\n",
+                ctx->m, m4ri_radix, B->nrows, B->ncols);
+        abort();
+    }
+    // B의 행 c = 각 b_j[c] 를 bit j 로 모은 word.
+    // pivot 행 i 로 소거: b_j[p_i] 가 1인 b_j 모두에 P_i 를 XOR
+    //   → P_i 의 켜진 열 c 마다 B[c] ^= B[p_i]  (64개를 word 하나로 동시에)
+    // full RREF 이므로 다른 pivot 행이 B[p_i] 를 바꾸지 않아 순서와 무관합니다.
+    for (rci_t i = 0; i < ctx->npiv; ++i) {
+        const word mask = mzd_row(B, ctx->pivots[i])[0];
+        if (!mask) continue;
+        const word *p = ctx->rows + (size_t)i * ctx->width;
+        for (rci_t w = 0; w < ctx->width; ++w) {
+            for (word x = p[w]; x; x &= x - 1) {
+                mzd_row(B, w * m4ri_radix + __builtin_ctzll(x))[0] ^= mask;
+            }
+        }
+    }
 
-    mzd_free(M);
-    return solvable;
+    // pivot 열은 이제 0이므로 비-pivot 열에 남은 비트가 풀리지 않는 b_j
+    word bad = 0;
+    for (rci_t c = 0; c < ctx->m; ++c) {
+        if (ctx->pivot_row[c] < 0) bad |= mzd_row(B, c)[0];
+    }
+    word cols = B->ncols == m4ri_radix ? ~(word)0 : ((m4ri_one << B->ncols) - 1);
+    return ~bad & cols;
 }
 
 void solver_free(solver_ctx_t *ctx) {
-    mzd_free(ctx->A_tr);
+    free(ctx->rows);
     free(ctx);
 }
 
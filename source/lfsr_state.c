@@ -1,6 +1,7 @@
 # include "lfsr_state.h"
 # include <m4ri/m4ri.h>
 # include <stdio.h>
+# include "packed_io.h"
 // Paste into lfsr_state.c:
 
 // Companion‑matrix cache
@@ -9,6 +10,10 @@ mzd_t *A2 = NULL;  // R2 companion matrix (22×22)
 mzd_t *A3 = NULL;  // R3 companion matrix (23×23)
 mzd_t *A4 = NULL;  // R4 companion matrix (17×17)
 
+// A^k power cache
+mzd_t   *A_pow[3][LFSR_POW_MAX + 1];
+uint32_t A_pow_cols[3][LFSR_POW_MAX + 1][LFSR_POW_MAX_LEN];
+
 // zS‑matrix cache
 mzd_t *zS_R1 = NULL;  // zS R1 matrix (ZS_ROWS×19)
 mzd_t *zS_R2 = NULL;  // zS R2 matrix (ZS_ROWS×22)
@@ -203,6 +208,37 @@ void extract_variables_from_state(lfsr_matrix_state_t* state) {
 
 
 
+// A_pow[r][k] = A·A_pow[r][k-1], 열 비트마스크도 같이 채움
+static void lfsr_pow_tables_init(void) {
+    mzd_t *A[3] = { A1, A2, A3 };
+    for (int r = 0; r < 3; ++r) {
+        int n = A[r]->nrows;
+        A_pow[r][0] = mzd_init(n, n);
+        for (int i = 0; i < n; ++i) mzd_write_bit(A_pow[r][0], i, i, 1);
+        for (int k = 1; k <= LFSR_POW_MAX; ++k) {
+            A_pow[r][k] = mzd_init(n, n);
+            mzd_mul(A_pow[r][k], A[r], A_pow[r][k - 1], 0);
+        }
+        for (int k = 0; k <= LFSR_POW_MAX; ++k) {
+            for (int j = 0; j < n; ++j) {
+                uint32_t col = 0;
+                for (int i = 0; i < n; ++i)
+                    col |= (uint32_t)mzd_read_bit(A_pow[r][k], i, j) << i;
+                A_pow_cols[r][k][j] = col;
+            }
+        }
+    }
+}
+
+void lfsr_count_clocks(const uint8_t *pattern, int from, int to, int k[3]) {
+    k[0] = k[1] = k[2] = 0;
+    for (int i = from; i < to; ++i) {
+        k[0] += (pattern[i] >> 2) & 1;
+        k[1] += (pattern[i] >> 1) & 1;
+        k[2] +=  pattern[i]       & 1;
+    }
+}
+
 // --- 전역 행렬 초기화 함수 ---
 void lfsr_matrices_init(void) {
     // A 행렬들 초기화
@@ -210,51 +246,45 @@ void lfsr_matrices_init(void) {
     if (!A2) A2 = lfsr_companion_matrix_transposed(0x622000, 22);
     if (!A3) A3 = lfsr_companion_matrix_transposed(0xCC0000, 23);
     if (!A4) A4 = lfsr_companion_matrix_transposed(0x26200, 17);
+
+    // A1..A3 의 거듭제곱 (k = 0..458)
+    if (!A_pow[0][0]) lfsr_pow_tables_init();
     
     // zS 행렬들 초기화 (한 번만)
     if (!zS_R1) {
-        FILE* fzS = fopen("data/zS.bin", "rb");
-        if (!fzS) {
+        // zS.bin: 행마다 R1(1..18) R2(1..21) R3(1..22) R4(1..16) 순서로 비트당 1바이트 (0/1)
+        enum { ZS_ROW_BYTES = 18 + 21 + 22 + 16 };
+        size_t bytes;
+        uint8_t* buf = packed_read_file("data/zS.bin", &bytes);
+        if (!buf) {
             fprintf(stderr, "[m4ri] Failed to open data/zS.bin\n");
             abort();
         }
-        
+        if (bytes != (size_t)ZS_ROWS * ZS_ROW_BYTES) {
+            fprintf(stderr, "[m4ri] data/zS.bin size %zu != expected %d\n",
+                    bytes, ZS_ROWS * ZS_ROW_BYTES);
+            abort();
+        }
+
         // zS 행렬들 할당
         zS_R1 = mzd_init(ZS_ROWS, 19);
         zS_R2 = mzd_init(ZS_ROWS, 22);
         zS_R3 = mzd_init(ZS_ROWS, 23);
         zS_R4 = mzd_init(ZS_ROWS, 17);
-        
-        // zS.bin에서 비트 읽어서 행렬로 설정
+
+        // 레지스터 하나가 word 하나에 들어가므로 행 word 를 바로 씀 (LSB 는 0, 나중에 정규화)
+        mzd_t* regs[4] = { zS_R1, zS_R2, zS_R3, zS_R4 };
+        const uint8_t* p = buf;
         for (int i = 0; i < ZS_ROWS; i++) {
-            // R1 (18 bits, excluding LSB)
-            for (int j = 1; j < 19; j++) {
-                int bit = fgetc(fzS);
-                mzd_write_bit(zS_R1, i, j, bit);
-            }
-            // R2 (21 bits, excluding LSB)
-            for (int j = 1; j < 22; j++) {
-                int bit = fgetc(fzS);
-                mzd_write_bit(zS_R2, i, j, bit);
-            }
-            // R3 (22 bits, excluding LSB)
-            for (int j = 1; j < 23; j++) {
-                int bit = fgetc(fzS);
-                mzd_write_bit(zS_R3, i, j, bit);
-            }
-            // R4 (16 bits, excluding LSB)
-            for (int j = 1; j < 17; j++) {
-                int bit = fgetc(fzS);
-                mzd_write_bit(zS_R4, i, j, bit);
+            for (int r = 0; r < 4; r++) {
+                word v = 0;
+                for (int j = 1; j < regs[r]->ncols; j++) {
+                    v |= (word)(*p++ & 1) << j;
+                }
+                mzd_row(regs[r], i)[0] = v;
             }
-            
-            // LSB는 0으로 설정 (나중에 정규화)
-            mzd_write_bit(zS_R1, i, 0, 0);
-            mzd_write_bit(zS_R2, i, 0, 0);
-            mzd_write_bit(zS_R3, i, 0, 0);
-            mzd_write_bit(zS_R4, i, 0, 0);
         }
-        fclose(fzS);
+        free(buf);
         printf("[m4ri] LFSR companion matrices and zS matrices initialized\n");
     }
 }
@@ -264,6 +294,12 @@ void lfsr_matrices_cleanup(void) {
     if (A2) { mzd_free(A2); A2 = NULL; }
     if (A3) { mzd_free(A3); A3 = NULL; }
     if (A4) { mzd_free(A4); A4 = NULL; }
+
+    for (int r = 0; r < 3; ++r) {
+        for (int k = 0; k <= LFSR_POW_MAX; ++k) {
+            if (A_pow[r][k]) { mzd_free(A_pow[r][k]); A_pow[r][k] = NULL; }
+        }
+    }
     
     if (zS_R1) { mzd_free(zS_R1); zS_R1 = NULL; }
     if (zS_R2) { mzd_free(zS_R2); zS_R2 = NULL; }
@@ -292,6 +328,14 @@ void lfsr_matrix_clock(mzd_t* lfsr, mzd_t* A) {
     mzd_free(tmp);
 }
 
+void lfsr_state_to_u32(const lfsr_matrix_state_t *state, lfsr_u32_state_t *out) {
+    // 1×len 행 하나는 word 하나의 하위 len 비트
+    out->R1 = (uint32_t)mzd_row_const(state->R1, 0)[0] & ((1u << LFSR_R1_LEN) - 1);
+    out->R2 = (uint32_t)mzd_row_const(state->R2, 0)[0] & ((1u << LFSR_R2_LEN) - 1);
+    out->R3 = (uint32_t)mzd_row_const(state->R3, 0)[0] & ((1u << LFSR_R3_LEN) - 1);
+    out->R4 = (uint32_t)mzd_row_const(state->R4, 0)[0] & ((1u << LFSR_R4_LEN) - 1);
+}
+
 int lfsr_matrix_get(const mzd_t* lfsr, int idx) {
     return mzd_read_bit(lfsr, 0, idx);
 }
@@ -0,0 +1,107 @@
+// File: packed_io.c
+#define _POSIX_C_SOURCE 200809L
+#include "packed_io.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint8_t *packed_read_file(const char *path, size_t *out_bytes) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    uint8_t *buf = malloc(len ? len : 1);
+    if (!buf) {
+        close(fd);
+        return NULL;
+    }
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = read(fd, buf + got, len - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            free(buf);
+            close(fd);
+            return NULL;
+        }
+        got += (size_t)n;
+    }
+    close(fd);
+    *out_bytes = len;
+    return buf;
+}
+
+// 각 바이트 안에서 비트 순서 뒤집기 (바이트끼리는 섞지 않음)
+static inline word rev_bits_in_bytes(word x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return x;
+}
+
+static inline word load_le64(const uint8_t *p) {
+    word x;
+    memcpy(&x, p, sizeof x);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+// MSB-first 비트열에서 pos 부터 64비트를 LSB-first word 로 (buf 끝 너머는 0)
+static inline word load_bits(const uint8_t *buf, size_t nbytes, size_t pos) {
+    size_t   byte = pos >> 3;
+    unsigned sh   = (unsigned)(pos & 7);
+    uint8_t  tmp[9];
+    const uint8_t *p = buf + byte;
+    if (byte + 9 > nbytes) {
+        size_t n = byte < nbytes ? nbytes - byte : 0;
+        memset(tmp, 0, sizeof tmp);
+        memcpy(tmp, p, n);
+        p = tmp;
+    }
+    word x = rev_bits_in_bytes(load_le64(p));
+    if (sh) {
+        x = (x >> sh) | (rev_bits_in_bytes((word)p[8]) << (64 - sh));
+    }
+    return x;
+}
+
+int mzd_unpack_msb(mzd_t *M, const uint8_t *buf, size_t nbytes, size_t bit_off) {
+    size_t cols = (size_t)M->ncols;
+    if (bit_off + (size_t)M->nrows * cols > nbytes * 8) return -1;
+    for (rci_t r = 0; r < M->nrows; r++) {
+        word  *row = mzd_row(M, r);
+        size_t pos = bit_off + (size_t)r * cols;
+        for (wi_t w = 0; w < M->width; w++) {
+            row[w] = load_bits(buf, nbytes, pos + (size_t)w * m4ri_radix);
+        }
+        row[M->width - 1] &= M->high_bitmask;
+    }
+    return 0;
+}
+
+mzd_t *packed_load_matrix(const char *path, rci_t rows, rci_t cols) {
+    size_t bytes;
+    uint8_t *buf = packed_read_file(path, &bytes);
+    if (!buf) return NULL;
+    if (bytes != ((size_t)rows * cols + 7) / 8) {
+        free(buf);
+        return NULL;
+    }
+    mzd_t *M = mzd_init(rows, cols);
+    if (M && mzd_unpack_msb(M, buf, bytes, 0) != 0) {
+        mzd_free(M);
+        M = NULL;
+    }
+    free(buf);
+    return M;
+}
@@ -0,0 +1,263 @@
+// File: r4_result.c
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "r4_result.h"
+
+#define R4_RESULT_HDR_BYTES 36
+#define R4_FP_SEED   0xcbf29ce484222325ULL   // FNV-1a 64
+#define R4_FP_PRIME  0x100000001b3ULL
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+// CRC-32 (IEEE 802.3, reflected 0xEDB88320). crc 는 이전 조각의 결과 (처음은 0)
+static uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= buf[i];
+        for (int k = 0; k < 8; ++k)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+// 헤더의 fingerprint 와 body 를 함께 덮는 CRC
+static uint32_t result_crc(const uint8_t *hdr, const uint8_t *body, size_t body_len) {
+    return crc32_update(crc32_update(0, hdr + 24, 8), body, body_len);
+}
+
+uint64_t r4_result_fingerprint(const word cht[NUM_BLOCKS]) {
+    uint64_t h = R4_FP_SEED;
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        for (int b = 0; b < 8; ++b) {
+            h ^= (uint8_t)(cht[j] >> (8 * b));
+            h *= R4_FP_PRIME;
+        }
+    }
+    return h;
+}
+
+uint64_t r4_result_global_fingerprint(void) {
+    word cht[NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        if (!cHt_vecs[j]) {
+            fprintf(stderr, "r4_result_global_fingerprint: call init_globals_core() first\n");
+            abort();
+        }
+        cht[j] = mzd_row_const(cHt_vecs[j], 0)[0];
+    }
+    return r4_result_fingerprint(cht);
+}
+
+int r4_shard_range(uint32_t i, uint32_t n, uint32_t *lo, uint32_t *hi) {
+    if (n == 0 || n > R4_SPACE || i >= n) return -1;
+    uint32_t base = R4_SPACE / n, rem = R4_SPACE % n;
+    *lo = i * base + (i < rem ? i : rem);
+    *hi = *lo + base + (i < rem ? 1 : 0);
+    return 0;
+}
+
+// path.tmp 에 쓰고 fsync 후 rename → 디렉터리도 fsync
+static int write_atomic(const char *path, const uint8_t *buf, size_t len) {
+    size_t plen = strlen(path);
+    char  *tmp  = malloc(plen + 5);
+    if (!tmp) return -1;
+    memcpy(tmp, path, plen);
+    memcpy(tmp + plen, ".tmp", 5);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        perror(tmp);
+        free(tmp);
+        return -1;
+    }
+    int ok = fwrite(buf, 1, len, f) == len;
+    ok &= fflush(f) == 0;
+    ok &= fsync(fileno(f)) == 0;
+    ok &= fclose(f) == 0;
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "r4_result: failed to write %s\n", path);
+        remove(tmp);
+        free(tmp);
+        return -1;
+    }
+    free(tmp);
+
+    // rename 자체가 디스크에 남도록 상위 디렉터리 fsync (실패해도 무시)
+    const char *slash = strrchr(path, '/');
+    char dir[4096] = ".";
+    if (slash && (size_t)(slash - path) < sizeof dir) {
+        size_t n = slash == path ? 1 : (size_t)(slash - path);
+        memcpy(dir, path, n);
+        dir[n] = '\0';
+    }
+    int dfd = open(dir, O_RDONLY);
+    if (dfd >= 0) {
+        fsync(dfd);
+        close(dfd);
+    }
+    return 0;
+}
+
+static int result_write(const char *path, uint32_t lo, uint32_t hi,
+                        uint64_t fingerprint, const uint8_t *status, bool partial)
+{
+    if (lo > hi || hi > R4_SPACE) {
+        fprintf(stderr, "r4_result_write: invalid range %u:%u\n", lo, hi);
+        return -1;
+    }
+
+    uint32_t n_inv = 0, n_val = 0;
+    for (uint32_t r4 = lo; r4 < hi; ++r4) {
+        switch (status[r4]) {
+        case R4_INVALID: n_inv++; break;
+        case R4_VALID:   n_val++; break;
+        case R4_NONE:    break;
+        default:
+            if (partial) break;
+            fprintf(stderr, "r4_result_write: R4 %u not evaluated\n", r4);
+            return -1;
+        }
+    }
+
+    size_t map_len  = partial ? (size_t)(hi - lo + 7) / 8 : 0;
+    size_t body_len = map_len + 2 * (size_t)(n_inv + n_val);
+    uint8_t *buf = calloc(R4_RESULT_HDR_BYTES + body_len, 1);
+    if (!buf) return -1;
+
+    uint8_t *body = buf + R4_RESULT_HDR_BYTES;
+    size_t   pi = map_len, pv = map_len + 2 * (size_t)n_inv;
+    for (uint32_t r4 = lo; r4 < hi; ++r4) {
+        if (partial && status[r4] != R4_PENDING) {
+            body[(r4 - lo) >> 3] |= (uint8_t)(1u << ((r4 - lo) & 7));
+        }
+        if (status[r4] == R4_INVALID) { put_u16(body + pi, (uint16_t)r4); pi += 2; }
+        else if (status[r4] == R4_VALID) { put_u16(body + pv, (uint16_t)r4); pv += 2; }
+    }
+
+    memcpy(buf, R4_RESULT_MAGIC, 4);
+    put_u16(buf + 4,  R4_RESULT_VERSION);
+    put_u16(buf + 6,  partial ? R4_RESULT_F_PARTIAL : 0);
+    put_u32(buf + 8,  lo);
+    put_u32(buf + 12, hi);
+    put_u32(buf + 16, n_inv);
+    put_u32(buf + 20, n_val);
+    put_u64(buf + 24, fingerprint);
+    put_u32(buf + 32, result_crc(buf, body, body_len));
+
+    int rc = write_atomic(path, buf, R4_RESULT_HDR_BYTES + body_len);
+    free(buf);
+    return rc;
+}
+
+int r4_result_write(const char *path, uint32_t lo, uint32_t hi,
+                    uint64_t fingerprint, const uint8_t *status)
+{
+    return result_write(path, lo, hi, fingerprint, status, false);
+}
+
+int r4_result_write_checkpoint(const char *path, uint32_t lo, uint32_t hi,
+                               uint64_t fingerprint, const uint8_t *status)
+{
+    return result_write(path, lo, hi, fingerprint, status, true);
+}
+
+int r4_result_read(const char *path, uint32_t *lo, uint32_t *hi,
+                   uint64_t *fingerprint, uint8_t *status)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    uint8_t hdr[R4_RESULT_HDR_BYTES];
+    if (fread(hdr, 1, sizeof hdr, f) != sizeof hdr ||
+        memcmp(hdr, R4_RESULT_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not an R4 result file\n", path);
+        fclose(f);
+        return -1;
+    }
+    if (get_u16(hdr + 4) != R4_RESULT_VERSION) {
+        fprintf(stderr, "%s: unsupported version %u\n", path, get_u16(hdr + 4));
+        fclose(f);
+        return -1;
+    }
+
+    uint16_t flags = get_u16(hdr + 6);
+    uint32_t flo = get_u32(hdr + 8), fhi = get_u32(hdr + 12);
+    uint32_t n_inv = get_u32(hdr + 16), n_val = get_u32(hdr + 20);
+    if ((flags & ~R4_RESULT_F_PARTIAL) || flo > fhi || fhi > R4_SPACE ||
+        (uint64_t)n_inv + n_val > fhi - flo) {
+        fprintf(stderr, "%s: corrupt header\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    bool   partial  = flags & R4_RESULT_F_PARTIAL;
+    size_t map_len  = partial ? (size_t)(fhi - flo + 7) / 8 : 0;
+    size_t body_len = map_len + 2 * (size_t)(n_inv + n_val);
+    uint8_t *body = malloc(body_len ? body_len : 1);
+    if (!body) abort();
+    if (fread(body, 1, body_len, f) != body_len || fgetc(f) != EOF) {
+        fprintf(stderr, "%s: truncated or trailing data\n", path);
+        free(body);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    if (result_crc(hdr, body, body_len) != get_u32(hdr + 32)) {
+        fprintf(stderr, "%s: CRC mismatch\n", path);
+        free(body);
+        return -1;
+    }
+
+    for (uint32_t r4 = flo; r4 < fhi; ++r4) {
+        bool done = !partial || ((body[(r4 - flo) >> 3] >> ((r4 - flo) & 7)) & 1);
+        status[r4] = done ? R4_NONE : R4_PENDING;
+    }
+    for (uint32_t k = 0; k < n_inv + n_val; ++k) {
+        uint32_t r4 = get_u16(body + map_len + 2 * (size_t)k);
+        if (r4 < flo || r4 >= fhi || status[r4] == R4_PENDING) {
+            fprintf(stderr, "%s: bad entry R4 %u (range %u:%u)\n", path, r4, flo, fhi);
+            free(body);
+            return -1;
+        }
+        status[r4] = k < n_inv ? R4_INVALID : R4_VALID;
+    }
+    free(body);
+
+    *lo = flo;
+    *hi = fhi;
+    if (fingerprint) *fingerprint = get_u64(hdr + 24);
+    return 0;
+}
@@ -0,0 +1,326 @@
+// File: r4_sweep.c
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "r4_sweep.h"
+
+#define R4_SWEEP_DEFAULT_CHUNK 16
+
+// 워커 하나의 chunk deque: 앞(head)에서는 주인이, 뒤(tail)에서는 도둑이 꺼냅니다.
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t       *chunks;    // 이 워커에 배분된 chunk 번호 (오름차순)
+    uint32_t        head, tail;
+} sweep_deque_t;
+
+typedef struct {
+    const r4_sweep_opts_t *opts;
+    uint8_t         *status;
+    uint32_t         chunk;      // chunk 당 R4 개수
+    uint32_t         nchunks;
+    int              nworkers;
+    sweep_deque_t   *deques;
+
+    // 순서 보장 출력: next_emit 미만의 R4는 모두 콜백 완료
+    pthread_mutex_t  emit_lock;
+    uint32_t         next_emit;
+
+    // checkpoint (emit_lock 으로 보호). 파일 쓰기는 잠금 밖에서 스냅샷으로 하고,
+    // 쓰는 중(ckpt_busy)에는 다른 워커가 또 쓰지 않음
+    double           next_checkpoint;
+    bool             ckpt_busy;
+    uint8_t         *ckpt_snap;  // R4_SPACE, [lo, hi) 만 사용
+} sweep_t;
+
+typedef struct {
+    sweep_t *sw;
+    int      id;
+} sweep_worker_arg_t;
+
+// ctht가 있으면 거기서 pin, 없으면 CtHt_cache[R4] (비어 있으면 계산)
+static const mzd_t *classify_acquire(uint16_t R4, ctht_lru_t *ctht) {
+    if (ctht) return ctht_lru_acquire(ctht, R4);
+    if (CtHt_cache[R4] == NULL) {
+        init_CtHt_for_r4(R4);
+    }
+    return CtHt_cache[R4];
+}
+
+r4_status_t r4_classify(uint16_t R4,
+                        const error_config_list_t *configs,
+                        r4_scratch_t *scratch,
+                        ctht_lru_t *ctht)
+{
+    // 전역 캡처 하나: invalid / valid 판정이 같은 소거를 나눠 씀
+    word cht[1][NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) cht[0][j] = mzd_row_const(cHt_vecs[j], 0)[0];
+
+    r4_scratch_prepare(classify_acquire(R4, ctht), scratch);
+    if (ctht) ctht_lru_release(ctht, R4);
+
+    word invalid, valid;
+    r4_classify_prepared(scratch, configs, (const word (*)[NUM_BLOCKS])cht, 1, &invalid, &valid);
+    return (invalid & 1) ? R4_INVALID : (valid & 1) ? R4_VALID : R4_NONE;
+}
+
+r4_status_t r4_capture_summary(const uint8_t *st, int n) {
+    int n_invalid = 0;
+    for (int c = 0; c < n; ++c) {
+        if (st[c] == R4_VALID) return R4_VALID;
+        n_invalid += st[c] == R4_INVALID;
+    }
+    return n > 0 && n_invalid == n ? R4_INVALID : R4_NONE;
+}
+
+r4_status_t r4_classify_captures(uint16_t R4,
+                                 const error_config_list_t *configs,
+                                 r4_scratch_t *scratch,
+                                 ctht_lru_t *ctht,
+                                 const capture_batch_t *batch,
+                                 uint8_t *out)
+{
+    r4_scratch_prepare(classify_acquire(R4, ctht), scratch);
+    if (ctht) ctht_lru_release(ctht, R4);
+
+    word invalid, valid;
+    r4_classify_prepared(scratch, configs, (const word (*)[NUM_BLOCKS])batch->cht, batch->n,
+                         &invalid, &valid);
+    for (int c = 0; c < batch->n; ++c) {
+        word bit = m4ri_one << c;
+        out[c] = (invalid & bit) ? R4_INVALID : (valid & bit) ? R4_VALID : R4_NONE;
+    }
+    return r4_capture_summary(out, batch->n);
+}
+
+// emit_lock을 잡은 상태에서 호출: 연속으로 완료된 구간을 오름차순으로 내보냄
+static void sweep_flush_locked(sweep_t *sw) {
+    const r4_sweep_opts_t *o = sw->opts;
+    while (sw->next_emit < o->hi && sw->status[sw->next_emit] != R4_PENDING) {
+        if (o->on_result) {
+            o->on_result((uint16_t)sw->next_emit,
+                         (r4_status_t)sw->status[sw->next_emit],
+                         o->user);
+        }
+        sw->next_emit++;
+    }
+}
+
+static double sweep_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned sweep_checkpoint_secs(const r4_sweep_opts_t *o) {
+    return o->checkpoint_secs ? o->checkpoint_secs : R4_SWEEP_CHECKPOINT_SECS;
+}
+
+// src 는 워커가 건드리지 않는 배열이어야 함 (스냅샷, 또는 워커가 끝난 뒤의 status)
+static int sweep_checkpoint_write(sweep_t *sw, const uint8_t *src) {
+    const r4_sweep_opts_t *o = sw->opts;
+    return r4_result_write_checkpoint(o->checkpoint_path, o->lo, o->hi, o->fingerprint, src);
+}
+
+static void sweep_complete(sweep_t *sw, uint32_t r4, r4_status_t st) {
+    const r4_sweep_opts_t *o = sw->opts;
+    bool write = false;
+
+    pthread_mutex_lock(&sw->emit_lock);
+    sw->status[r4] = (uint8_t)st;
+    if (r4 == sw->next_emit) {
+        sweep_flush_locked(sw);
+    }
+    // 잠금 안에서는 스냅샷만 뜨고, fsync 가 있는 파일 쓰기는 잠금을 놓고 함
+    if (o->checkpoint_path && !sw->ckpt_busy && sweep_now() >= sw->next_checkpoint) {
+        memcpy(sw->ckpt_snap + o->lo, sw->status + o->lo, o->hi - o->lo);
+        sw->ckpt_busy       = true;
+        sw->next_checkpoint = sweep_now() + sweep_checkpoint_secs(o);
+        write = true;
+    }
+    pthread_mutex_unlock(&sw->emit_lock);
+
+    if (write) {
+        // 실패해도 sweep은 계속하고 다음 주기에 다시 시도
+        sweep_checkpoint_write(sw, sw->ckpt_snap);
+        pthread_mutex_lock(&sw->emit_lock);
+        sw->ckpt_busy = false;
+        pthread_mutex_unlock(&sw->emit_lock);
+    }
+}
+
+static bool deque_pop_front(sweep_deque_t *d, uint32_t *c) {
+    bool ok = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *c = d->chunks[d->head++];
+        ok = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static bool deque_pop_back(sweep_deque_t *d, uint32_t *c) {
+    bool ok = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *c = d->chunks[--d->tail];
+        ok = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static uint32_t deque_remaining(sweep_deque_t *d) {
+    pthread_mutex_lock(&d->lock);
+    uint32_t n = d->tail - d->head;
+    pthread_mutex_unlock(&d->lock);
+    return n;
+}
+
+// 자기 deque에서 먼저 꺼내고, 비었으면 가장 많이 남은 워커에게서 훔침
+static bool sweep_take_chunk(sweep_t *sw, int id, uint32_t *c) {
+    if (deque_pop_front(&sw->deques[id], c)) return true;
+    for (;;) {
+        int      victim = -1;
+        uint32_t best   = 0;
+        for (int w = 0; w < sw->nworkers; ++w) {
+            if (w == id) continue;
+            uint32_t n = deque_remaining(&sw->deques[w]);
+            if (n > best) { best = n; victim = w; }
+        }
+        if (victim < 0) return false;              // 남은 일이 없음
+        if (deque_pop_back(&sw->deques[victim], c)) return true;
+        // 그 사이 비었으면 다시 고름
+    }
+}
+
+static void *sweep_worker(void *arg) {
+    sweep_worker_arg_t *a  = arg;
+    sweep_t            *sw = a->sw;
+    const r4_sweep_opts_t *o = sw->opts;
+
+    r4_scratch_t scratch;
+    r4_scratch_init(&scratch);
+
+    uint32_t c;
+    while (sweep_take_chunk(sw, a->id, &c)) {
+        uint32_t lo = o->lo + c * sw->chunk;
+        uint32_t hi = lo + sw->chunk;
+        if (hi > o->hi) hi = o->hi;
+        for (uint32_t r4 = lo; r4 < hi; ++r4) {
+            // chunk는 한 워커만 처리하므로 잠금 없이 읽어도 됨
+            if (sw->status[r4] != R4_PENDING) continue;
+            r4_status_t st;
+            if (o->captures) {
+                uint8_t per[CAPTURE_BATCH_MAX];
+                st = r4_classify_captures((uint16_t)r4, o->configs, &scratch, o->ctht,
+                                          o->captures, per);
+                for (int k = 0; k < o->captures->n; ++k) {
+                    o->capture_status[(size_t)k * R4_SPACE + r4] = per[k];
+                }
+            } else {
+                st = r4_classify((uint16_t)r4, o->configs, &scratch, o->ctht);
+            }
+            sweep_complete(sw, r4, st);
+        }
+    }
+
+    r4_scratch_free(&scratch);
+    return NULL;
+}
+
+int r4_sweep_run(const r4_sweep_opts_t *opts, uint8_t *status) {
+    if (!opts || !status || opts->lo > opts->hi || opts->hi > R4_SPACE) {
+        fprintf(stderr, "r4_sweep_run: invalid range\n");
+        return -1;
+    }
+    // checkpoint 는 요약 status 만 담으므로 캡처별 결과를 재개할 수 없음
+    if (opts->captures && (!opts->capture_status || opts->checkpoint_path)) {
+        fprintf(stderr, "r4_sweep_run: capture mode needs capture_status and no checkpoint\n");
+        return -1;
+    }
+
+    sweep_t sw = {0};
+    sw.opts      = opts;
+    sw.status    = status;
+    sw.chunk     = opts->chunk ? opts->chunk : R4_SWEEP_DEFAULT_CHUNK;
+    sw.nchunks   = (opts->hi - opts->lo + sw.chunk - 1) / sw.chunk;
+    sw.next_emit = opts->lo;
+    sw.next_checkpoint = sweep_now() + sweep_checkpoint_secs(opts);
+    pthread_mutex_init(&sw.emit_lock, NULL);
+
+    // 이미 끝난(재개된) 앞부분은 바로 내보냄
+    sweep_flush_locked(&sw);
+    if (sw.nchunks == 0) {
+        pthread_mutex_destroy(&sw.emit_lock);
+        return opts->checkpoint_path ? sweep_checkpoint_write(&sw, status) : 0;
+    }
+    if (opts->checkpoint_path) {
+        sw.ckpt_snap = malloc(R4_SPACE);
+        if (!sw.ckpt_snap) abort();
+    }
+
+    int n = opts->nthreads;
+    if (n <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cpus > 0 ? (int)cpus : 1;
+    }
+    if ((uint32_t)n > sw.nchunks) n = (int)sw.nchunks;
+    sw.nworkers = n;
+
+    // chunk c → 워커 c % n (라운드로빈), 각 deque는 오름차순
+    sw.deques = calloc((size_t)n, sizeof(sweep_deque_t));
+    if (!sw.deques) abort();
+    for (int w = 0; w < n; ++w) {
+        uint32_t cnt = (sw.nchunks - (uint32_t)w + (uint32_t)n - 1) / (uint32_t)n;
+        sw.deques[w].chunks = malloc(sizeof(uint32_t) * (cnt ? cnt : 1));
+        if (!sw.deques[w].chunks) abort();
+        pthread_mutex_init(&sw.deques[w].lock, NULL);
+    }
+    for (uint32_t c = 0; c < sw.nchunks; ++c) {
+        sweep_deque_t *d = &sw.deques[c % (uint32_t)n];
+        d->chunks[d->tail++] = c;
+    }
+
+    // 워커 0은 호출한 스레드에서 실행
+    pthread_t          *tids = calloc((size_t)n, sizeof(pthread_t));
+    sweep_worker_arg_t *args = calloc((size_t)n, sizeof(sweep_worker_arg_t));
+    if (!tids || !args) abort();
+    int started = 1;
+    for (int w = 0; w < n; ++w) {
+        args[w].sw = &sw;
+        args[w].id = w;
+    }
+    for (int w = 1; w < n; ++w) {
+        if (pthread_create(&tids[w], NULL, sweep_worker, &args[w]) != 0) {
+            // 남은 chunk는 이미 뜬 워커들이 훔쳐서 처리
+            fprintf(stderr, "r4_sweep_run: pthread_create failed for worker %d\n", w);
+            break;
+        }
+        started++;
+    }
+    sweep_worker(&args[0]);
+    for (int w = 1; w < started; ++w) {
+        pthread_join(tids[w], NULL);
+    }
+
+    for (int w = 0; w < n; ++w) {
+        pthread_mutex_destroy(&sw.deques[w].lock);
+        free(sw.deques[w].chunks);
+    }
+    free(sw.deques);
+    free(tids);
+    free(args);
+
+    // 마지막 상태를 남겨 두면 같은 명령으로 --resume 해도 바로 끝남 (워커는 모두 끝남)
+    int rc = 0;
+    if (opts->checkpoint_path) {
+        rc = sweep_checkpoint_write(&sw, status);
+    }
+    free(sw.ckpt_snap);
+    pthread_mutex_destroy(&sw.emit_lock);
+    return rc;
+}
@@ -1,8 +1,288 @@
-
+#include <string.h>
 #include "decrypt.h"
+#include "error_bits.h"
+#include "packed_io.h"
+#include "capture.h"
+#include "r4_sweep.h"
+
+// A^k 점프가 clock 을 k 번 한 것과 같은지 k = 0..LFSR_POW_MAX 전부 확인
+//  - update_LSegment_k(k) ↔ update_LSegment k 번 (A_pow[r][k])
+//  - lfsr_pow_apply(r, k, x) ↔ 열 벡터 x 에 A_r 을 k 번 곱함 (A_pow_cols)
+static int check_pow_tables(void) {
+    lfsr_matrices_init();
+
+    const uint16_t off[3] = { VAR_OFF_R1, VAR_OFF_R2, VAR_OFF_R3 };
+    const uint16_t len[3] = { VAR_LEN_R1, VAR_LEN_R2, VAR_LEN_R3 };
+    const mzd_t   *A[3]   = { A1, A2, A3 };
+    int bad = 0;
+    for (int r = 1; r <= 3; ++r) {
+        int n = A[r - 1]->nrows;
+        LSegment step, jump;
+        init_LSegment(&step, off[r - 1], len[r - 1], (uint8_t)r);
+
+        mzd_t *x  = mzd_init(n, 1);
+        mzd_t *x1 = mzd_init(n, 1);
+        mzd_randomize(x);
+        uint32_t x0 = 0;
+        for (int i = 0; i < n; ++i) x0 |= (uint32_t)mzd_read_bit(x, i, 0) << i;
+
+        for (int k = 0; k <= LFSR_POW_MAX; ++k) {
+            init_LSegment(&jump, off[r - 1], len[r - 1], (uint8_t)r);
+            update_LSegment_k(&jump, k);
+            uint32_t xk = 0;
+            for (int i = 0; i < n; ++i) xk |= (uint32_t)mzd_read_bit(x, i, 0) << i;
+            if (!mzd_equal(jump.L, step.L) || lfsr_pow_apply(r, k, x0) != xk) {
+                fprintf(stderr, "A^k mismatch for R%d, k=%d\n", r, k);
+                bad++;
+            }
+            free_LSegment(&jump);
+
+            update_LSegment(&step);
+            mzd_mul_naive(x1, A[r - 1], x);
+            mzd_copy(x, x1);
+        }
+        free_LSegment(&step);
+        mzd_free(x);
+        mzd_free(x1);
+    }
+    printf("A^k table check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// 워드 단위 빌더가 LSegment 기반 원본과 같은 C를 만드는지 R4 표본으로 확인
+static int check_builder_against_ref(void) {
+    init_clock_patterns();
+    lfsr_matrices_init();
+
+    mzd_t *C_fast = mzd_init(C_ROWS, TOTAL_VARS);
+    mzd_t *C_ref  = mzd_init(C_ROWS, TOTAL_VARS);
+    int bad = 0;
+    for (uint32_t r4 = 0; r4 < R4_SPACE; r4 += 1021) {
+        const uint8_t *pattern = get_clock_pattern((uint16_t)r4);
+        mzd_set_ui(C_ref, 0);
+        build_linear_system_with_pattern_ref(pattern, C_ref);
+        build_linear_system_with_pattern(pattern, C_fast);
+        if (!mzd_equal(C_fast, C_ref)) {
+            fprintf(stderr, "C mismatch for R4=%u\n", r4);
+            bad++;
+        }
+    }
+    mzd_free(C_fast);
+    mzd_free(C_ref);
+    printf("Builder check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// rank-1 누적으로 만든 CtHt가 C 전치 후 곱한 결과와 같은지 확인 (H 필요)
+static int check_ctht_against_ref(void) {
+    init_H();
+
+    mzd_t *CtHt_fast = mzd_init(TOTAL_VARS, Ht->ncols);
+    mzd_t *CtHt_ref  = mzd_init(TOTAL_VARS, Ht->ncols);
+    int bad = 0;
+    for (uint32_t r4 = 0; r4 < R4_SPACE; r4 += 1021) {
+        build_CtHt_for_r4_ref((uint16_t)r4, CtHt_ref);
+        build_CtHt_for_r4((uint16_t)r4, CtHt_fast);
+        if (!mzd_equal(CtHt_fast, CtHt_ref)) {
+            fprintf(stderr, "CtHt mismatch for R4=%u\n", r4);
+            bad++;
+        }
+    }
+    mzd_free(CtHt_fast);
+    mzd_free(CtHt_ref);
+    printf("CtHt check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// sparse V_DIFF 의 행렬 곱 / 벡터 곱이 zS 에서 곧바로 만든 dense M 과의 곱과 같은지 확인
+static int check_v_diff_mul(void) {
+    init_v_diff_matrices();
+
+    mzd_t *X    = mzd_init(V_DIFF_SIZE, 100);
+    mzd_t *fast = mzd_init(V_DIFF_SIZE, 100);
+    mzd_t *ref  = mzd_init(V_DIFF_SIZE, 100);
+    mzd_t *v    = mzd_init(1, V_DIFF_SIZE);
+    mzd_t *vf   = mzd_init(1, V_DIFF_SIZE);
+    mzd_t *vr   = mzd_init(1, V_DIFF_SIZE);
+    mzd_randomize(X);
+    mzd_randomize(v);
+    int bad = 0;
+    for (int i = 0; i < V_DIFF_COUNT; ++i) {
+        mzd_t *M  = v_diff_to_dense_ref(i);
+        mzd_t *Ms = v_diff_to_dense(i);
+        mzd_mul_naive(ref, M, X);
+        v_diff_mul(fast, i, X);
+        mzd_mul_naive(vr, v, M);
+        v_diff_apply_vec(vf, i, v);
+        if (!mzd_equal(Ms, M)) {
+            fprintf(stderr, "V_DIFF entries differ from dense reference for block %d\n", i + 1);
+            bad++;
+        }
+        if (!mzd_equal(fast, ref) || !mzd_equal(vf, vr)) {
+            fprintf(stderr, "V_DIFF product mismatch for block %d\n", i + 1);
+            bad++;
+        }
+        mzd_free(M);
+        mzd_free(Ms);
+    }
+    mzd_free(X);
+    mzd_free(fast);
+    mzd_free(ref);
+    mzd_free(v);
+    mzd_free(vf);
+    mzd_free(vr);
+    printf("V_DIFF check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// assemble_system_T 가 블록별 조립 → 쌓기 → 전치 결과와 같은지 확인
+static int check_assemble_T(void) {
+    init_globals_core();
+
+    mzd_t *CtHt = mzd_init(TOTAL_VARS, H_ROWS);
+    mzd_t *AT   = mzd_init(TOTAL_VARS - 1, NUM_BLOCKS * H_ROWS);
+    mzd_t *A_list[NUM_BLOCKS], *b_list[NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        A_list[j] = mzd_init(H_ROWS, TOTAL_VARS - 1);
+        b_list[j] = mzd_init(H_ROWS, 1);
+    }
+    int bad = 0;
+    for (uint32_t r4 = 0; r4 < R4_SPACE; r4 += 4099) {
+        build_CtHt_for_r4((uint16_t)r4, CtHt);
+        word b_bits[NUM_BLOCKS];
+        assemble_system_T(CtHt, AT, b_bits);
+
+        assemble_system_from(CtHt, A_list, b_list);
+        mzd_t *A_full = NULL;
+        assemble_A_for_unknown((const mzd_t **)A_list, -1, &A_full);
+        mzd_t *ref = mzd_transpose(NULL, A_full);
+        int ok = mzd_equal(AT, ref);
+        for (int j = 0; j < NUM_BLOCKS; ++j) {
+            for (int r = 0; r < H_ROWS; ++r) {
+                ok &= (int)((b_bits[j] >> r) & 1) == mzd_read_bit(b_list[j], r, 0);
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "assemble_system_T mismatch for R4=%u\n", r4);
+            bad++;
+        }
+        mzd_free(ref);
+        mzd_free(A_full);
+    }
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        mzd_free(A_list[j]);
+        mzd_free(b_list[j]);
+    }
+    mzd_free(CtHt);
+    mzd_free(AT);
+    printf("Assemble check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// mzd_unpack_msb 가 비트 단위 MSB-first 언패킹과 같은지 (바이트 경계가 아닌 행·시작 위치 포함)
+static int check_unpack_msb(void) {
+    static const rci_t shapes[][2] = { { 48, 208 }, { 13, 37 }, { 7, 130 }, { 1, 1 } };
+    uint8_t buf[1300];
+    for (size_t i = 0; i < sizeof buf; ++i) buf[i] = (uint8_t)(i * 151 + 7);
+    int bad = 0;
+    for (size_t t = 0; t < sizeof shapes / sizeof shapes[0]; ++t) {
+        for (size_t off = 0; off < 9; off += 3) {
+            mzd_t *M = mzd_init(shapes[t][0], shapes[t][1]);
+            if (mzd_unpack_msb(M, buf, sizeof buf, off) != 0) {
+                bad++;
+            } else {
+                for (rci_t r = 0; r < M->nrows; ++r) {
+                    for (rci_t c = 0; c < M->ncols; ++c) {
+                        size_t idx = off + (size_t)r * M->ncols + c;
+                        bad += mzd_read_bit(M, r, c) != ((buf[idx >> 3] >> (7 - (idx & 7))) & 1);
+                    }
+                    bad += (mzd_row(M, r)[M->width - 1] & ~M->high_bitmask) != 0;
+                }
+            }
+            mzd_free(M);
+        }
+    }
+    mzd_t *S = mzd_init(1, 64);
+    bad += mzd_unpack_msb(S, buf, 8, 1) != -1;   // 짧은 버퍼는 거부
+    mzd_free(S);
+    printf("Unpack check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// 캡처 묶음 판정이 캡처를 하나씩 판정한 것과 같은지, 전역 캡처와 같은 c·Ht 를 읽는지 확인
+static int check_capture_batch(void) {
+    init_globals_core();
+    error_config_list_t configs;
+    error_configs_init(&configs);
+    r4_scratch_t scratch;
+    r4_scratch_init(&scratch);
+    int bad = 0;
+
+    // manifest 는 주석·빈 줄을 건너뛰고 scramble 이 없으면 기본값
+    const char *mpath = "ct_build_test.manifest";
+    FILE *f = fopen(mpath, "w");
+    fprintf(f, "# captures\n\n%s   # default scramble\n%s %s\n",
+            CIPHERTEXT_PATH, CIPHERTEXT_PATH, SCRAMBLE_PATH);
+    fclose(f);
+    capture_list_t list = {0};
+    bad += capture_list_from_manifest(&list, mpath, SCRAMBLE_PATH) != 0 || list.n != 2;
+    remove(mpath);
+
+    capture_batch_t batch;
+    bad += capture_batch_load(&batch, &list, 0, list.n) != 0 || batch.n != 2;
+
+    // data/ 에서는 암호문 크기인 ciphertext.bin 만 캡처 (H.bin, Gt.bin, s.bin, zS.bin 은 아님)
+    capture_list_t dir_list = {0};
+    bad += capture_list_from_dir(&dir_list, "data", SCRAMBLE_PATH) != 0 || dir_list.n != 1 ||
+           strcmp(dir_list.cipher[0], "data/ciphertext.bin") != 0;
+    capture_list_free(&dir_list);
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        bad += batch.cht[0][j] != mzd_row_const(cHt_vecs[j], 0)[0];
+    }
+    capture_list_free(&list);
+
+    // 캡처: 0 전역, 1 임의, 2 b = 0 (항상 valid), 3 b = 블록 3 의 단일 비트 오류 (known 설정)
+    const word mask = (m4ri_one << H_ROWS) - 1;
+    batch.n = 4;
+    for (uint32_t r4 = 1; r4 < R4_SPACE; r4 += 8191) {
+        init_CtHt_for_r4((uint16_t)r4);
+        r4_scratch_prepare(CtHt_cache[r4], &scratch);
+        for (int j = 0; j < NUM_BLOCKS; ++j) {
+            batch.cht[1][j] = ((word)rand() << 24 ^ (word)rand()) & mask;
+            batch.cht[2][j] = scratch.b0[j];
+            batch.cht[3][j] = scratch.b0[j] ^ (j == 3 ? configs.syndrome[r4 % CIPHERTEXT_SIZE] : 0);
+        }
+
+        uint8_t per[CAPTURE_BATCH_MAX];
+        r4_classify_captures((uint16_t)r4, &configs, &scratch, NULL, &batch, per);
+        int ok = per[0] == r4_classify((uint16_t)r4, &configs, &scratch, NULL)
+              && per[2] == R4_VALID && per[3] == R4_VALID;
+        r4_scratch_prepare(CtHt_cache[r4], &scratch);
+        for (int c = 0; c < batch.n; ++c) {
+            word invalid, valid;
+            r4_classify_prepared(&scratch, &configs, (const word (*)[NUM_BLOCKS])&batch.cht[c], 1,
+                                 &invalid, &valid);
+            uint8_t one = invalid ? R4_INVALID : valid ? R4_VALID : R4_NONE;
+            ok &= one == per[c];
+        }
+        if (!ok) {
+            fprintf(stderr, "capture batch mismatch for R4=%u\n", r4);
+            bad++;
+        }
+    }
+    r4_scratch_free(&scratch);
+    printf("Capture batch check: %s\n", bad ? "FAILED" : "OK");
+    return bad;
+}
 
 int main(void){
+    if (check_unpack_msb() != 0) return 1;
+    if (check_pow_tables() != 0) return 1;
+    if (check_builder_against_ref() != 0) return 1;
+    if (check_ctht_against_ref() != 0) return 1;
+    if (check_v_diff_mul() != 0) return 1;
+    if (check_assemble_T() != 0) return 1;
+    if (check_capture_batch() != 0) return 1;
     test_ct_build();
     printf("Test completed successfully.\n");
 }
-
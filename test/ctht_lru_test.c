@@ -0,0 +1,143 @@
+// ctht_lru_test.c — 용량이 작은 CtHt LRU 캐시를 여러 스레드로 두드려 pin 과 통계 확인
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include "ctht_cache.h"
+
+#define CAPACITY     12      // working set 보다 작게
+#define WORKING_SET  48
+#define NTHREADS     8
+#define ITERS        20000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "FAILED: " __VA_ARGS__);            \
+            fprintf(stderr, "\n");                              \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t        calls;
+} fill_log_t;
+
+// R4 와 행 번호로 정해지는 48비트 값: 다른 R4 로 덮어써지면 바로 드러남
+static word pattern(uint16_t r4, int row) {
+    uint64_t x = ((uint64_t)r4 << 32 | (uint32_t)row) * 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 29;
+    return (word)(x & ((1ULL << CTHT_COLS) - 1));
+}
+
+static void fake_fill(uint16_t r4, word *dst, void *user) {
+    fill_log_t *log = user;
+    for (int r = 0; r < CTHT_ENTRY_WORDS; ++r) dst[r] = pattern(r4, r);
+    pthread_mutex_lock(&log->lock);
+    log->calls++;
+    pthread_mutex_unlock(&log->lock);
+}
+
+// pin 된 뷰가 아직 r4 의 내용인지
+static bool view_matches(const mzd_t *view, uint16_t r4) {
+    for (int r = 0; r < CTHT_ROWS; ++r) {
+        if (mzd_row_const(view, r)[0] != pattern(r4, r)) return false;
+    }
+    return true;
+}
+
+typedef struct {
+    ctht_lru_t *lru;
+    unsigned    seed;
+    uint64_t    acquires;
+    uint64_t    bad;        // 내용이 틀리거나 pin 도중 바뀐 횟수
+} worker_t;
+
+// 매번 R4 한두 개를 pin 하고, 양보한 뒤에도 내용이 그대로인지 확인한 다음 release.
+// 두 개를 쥐는 스레드가 많으면 모든 slot 이 pin 되어 acquire 가 기다리는 경로도 지납니다.
+static void *worker(void *arg) {
+    worker_t *w = arg;
+    for (int it = 0; it < ITERS; ++it) {
+        int      n = 1 + rand_r(&w->seed) % 2;
+        uint16_t r4[2];
+        const mzd_t *view[2];
+        for (int k = 0; k < n; ++k) {
+            // 이웃 스레드와 겹치도록 R4_SPACE 전체에 흩어 둔 작은 working set
+            r4[k]   = (uint16_t)((rand_r(&w->seed) % WORKING_SET) * 1361u);
+            view[k] = ctht_lru_acquire(w->lru, r4[k]);
+            w->acquires++;
+            if (!view_matches(view[k], r4[k])) w->bad++;
+        }
+        sched_yield();
+        for (int k = n - 1; k >= 0; --k) {
+            if (!view_matches(view[k], r4[k])) w->bad++;
+            ctht_lru_release(w->lru, r4[k]);
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    fill_log_t log = { .calls = 0 };
+    pthread_mutex_init(&log.lock, NULL);
+
+    ctht_lru_t lru;
+    if (ctht_lru_init(&lru, CAPACITY, fake_fill, &log) != 0) return 1;
+
+    pthread_t th[NTHREADS];
+    worker_t  w[NTHREADS];
+    for (int t = 0; t < NTHREADS; ++t) {
+        w[t] = (worker_t){ .lru = &lru, .seed = 1234u + (unsigned)t };
+        pthread_create(&th[t], NULL, worker, &w[t]);
+    }
+    uint64_t acquires = 0, bad = 0;
+    for (int t = 0; t < NTHREADS; ++t) {
+        pthread_join(th[t], NULL);
+        acquires += w[t].acquires;
+        bad      += w[t].bad;
+    }
+    CHECK(bad == 0, "%llu views had wrong content or changed while pinned",
+          (unsigned long long)bad);
+
+    ctht_lru_stats_t st;
+    ctht_lru_get_stats(&lru, &st);
+    uint32_t resident = 0, pinned = 0;
+    for (uint32_t s = 0; s < lru.capacity; ++s) {
+        resident += lru.r4_of[s] >= 0;
+        pinned   += lru.pins[s] != 0;
+    }
+    printf("acquires %llu: %llu hits, %llu misses, %llu evictions\n",
+           (unsigned long long)acquires, (unsigned long long)st.hits,
+           (unsigned long long)st.misses, (unsigned long long)st.evictions);
+
+    CHECK(st.hits + st.misses == acquires, "hits + misses != acquires");
+    CHECK(st.misses == log.calls, "misses %llu != fill calls %llu",
+          (unsigned long long)st.misses, (unsigned long long)log.calls);
+    CHECK(resident == CAPACITY, "%u resident entries, expected %d", resident, CAPACITY);
+    CHECK(st.evictions == st.misses - resident, "evictions != misses - resident");
+    CHECK(st.evictions > 0 && st.hits > 0, "working set did not exercise both hits and evictions");
+    CHECK(pinned == 0, "%u slots still pinned after all releases", pinned);
+
+    // 남아 있는 항목은 모두 제 R4 의 내용이고 slot_of 와 맞물림
+    for (uint32_t s = 0; s < lru.capacity; ++s) {
+        int32_t r4 = lru.r4_of[s];
+        if (r4 < 0) continue;
+        CHECK(lru.slot_of[r4] == (int32_t)s, "slot_of[%d] does not point back to slot %u", r4, s);
+        CHECK(view_matches(ctht_slab_view(&lru.slab, s), (uint16_t)r4), "slot %u content", s);
+    }
+
+    ctht_lru_free(&lru);
+    pthread_mutex_destroy(&log.lock);
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All ctht_lru tests passed!\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <m4ri/m4ri.h>
 #include <stdint.h>
@@ -15,6 +16,11 @@ int main(void) {
     srand((unsigned)time(NULL));
     init_clock_patterns();
 
+    // 7-2) bitsliced 경로는 KS_BS_LANES 개씩 모아서 한 번에 검증
+    static lfsr_u32_state_t bs_regs[KS_BS_LANES];
+    static word bs_ref[KS_BS_LANES][KEYSTREAM_WORDS], bs_z[KS_BS_LANES][KEYSTREAM_WORDS];
+    int bs_n = 0;
+
     for (int t = 0; t < NTESTS; ++t) {
         // 1) 각 LFSR 초기값을 무작위로 생성 (LSB를 1로 고정)
         uint32_t R1_init = (rand() & ((1u << 19) - 1)) | 1u;
@@ -62,6 +68,25 @@ int main(void) {
         // 7) z 벡터 내용이 같은지 검증
         assert(mzd_cmp(zC, zL) == 0);
 
+        // 7-1) uint32 레지스터 경로도 같은 keystream 을 내는지 검증
+        lfsr_u32_state_t regs;
+        word zN[KEYSTREAM_WORDS];
+        lfsr_state_to_u32(&stateC, &regs);
+        keystream_generation_with_pattern_u32(&regs, get_clock_pattern((uint16_t)(R4_init >> 1)), zN);
+        for (int j = 0; j < CIPHERTEXT_SIZE; ++j) {
+            assert((int)((zN[j / 64] >> (j % 64)) & 1) == mzd_read_bit(zC, 0, j));
+        }
+
+        bs_regs[bs_n] = regs;
+        memcpy(bs_ref[bs_n], zN, sizeof zN);
+        if (++bs_n == KS_BS_LANES || t == NTESTS - 1) {
+            keystream_generation_bs(bs_regs, bs_n, bs_z);
+            for (int l = 0; l < bs_n; ++l) {
+                assert(memcmp(bs_z[l], bs_ref[l], sizeof bs_z[l]) == 0);
+            }
+            bs_n = 0;
+        }
+
         // 8) 정리
         for (int r = 0; r < 4; ++r) {
             mzd_free(regsC[r]);
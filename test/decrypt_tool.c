@@ -5,15 +5,15 @@
 #include <m4ri/m4ri.h>
 #include "lfsr_state.h"    // lfsr_matrices_init, lfsr_matrix_initialization, lfsr_matrices_cleanup
 #include "encrypt.h"       // extract_variables_from_state, expand_states_linearized_m4ri
-#include "decrypt.h"       // init_v_diff_matrices, free_v_diff_matrices, V_DIFF_MATS
+#include "decrypt.h"       // init_v_diff_matrices, free_v_diff_matrices, v_diff_apply_vec
 
 int main(void) {
     // 1) Initialize companion matrices and zS
     lfsr_matrices_init();
 
-    // 2) Build V_DIFF_MATS
+    // 2) Build V_DIFF
     init_v_diff_matrices();
-    printf("V_DIFF_MATS initialized for %d blocks.\n", V_DIFF_COUNT);
+    printf("V_DIFF initialized for %d blocks.\n", V_DIFF_COUNT);
 
 // 3) Prepare state0 and v0
     uint32_t R1_init = (rand() & ((1u << 19) - 1)) | 1u;
@@ -52,8 +52,8 @@ int main(void) {
             // block 0: identity
             mzd_copy(vvd, state0.v);
         } else {
-            // block i>0: use V_DIFF_MATS[i-1]
-            mzd_mul(vvd, state0.v, V_DIFF_MATS[i-1],0);
+            // block i>0: use V_DIFF[i-1]
+            v_diff_apply_vec(vvd, i-1, state0.v);
         }
 
         // Compare bits
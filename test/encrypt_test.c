@@ -1,4 +1,5 @@
 #include "encrypt.h"
+#include "encrypt_stream.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -64,7 +65,115 @@ int main() {
     }
     printf("SUCCESS: R4 bits written\n");
     
-    printf("Step 6: Cleanup...\n");
+    printf("Step 6: Testing table key setup against m4ri key injection...\n");
+    srand(12345);
+    for (int t = 0; t < 200; t++) {
+        int K[KEY_SIZE], N[NONCE_SIZE];
+        uint64_t Kw = 0;
+        uint32_t Nw = 0;
+        for (int i = 0; i < KEY_SIZE; i++)   { K[i] = rand() & 1; Kw |= (uint64_t)K[i] << i; }
+        for (int i = 0; i < NONCE_SIZE; i++) { N[i] = rand() & 1; Nw |= (uint32_t)N[i] << i; }
+        lfsr_u32_state_t ref, tab;
+        lfsr_key_setup_m4ri(K, N, &ref);
+        lfsr_key_setup(Kw, Nw, &tab);
+        if (ref.R1 != tab.R1 || ref.R2 != tab.R2 || ref.R3 != tab.R3 || ref.R4 != tab.R4) {
+            printf("FAILED: key setup mismatch at trial %d\n", t);
+            mzd_free(R1);
+            mzd_free(R2);
+            mzd_free(R3);
+            mzd_free(R4);
+            return 1;
+        }
+    }
+    printf("SUCCESS: 200 key/nonce pairs match\n");
+
+    printf("Step 7: Testing streaming encryption past 15 blocks...\n");
+    {
+        enum { NBLK = 40 };
+        static int Gt[CIPHERTEXT_SIZE * PLAINTEXT_BLOCK_SIZE];
+        int K[KEY_SIZE], s[CIPHERTEXT_SIZE];
+        uint8_t pt[NBLK * ENC_PT_BLOCK_BYTES - 7];   // 마지막 블록은 final 에서 0 패딩
+        static uint8_t ct[NBLK * ENC_CT_BLOCK_BYTES];
+        for (int i = 0; i < CIPHERTEXT_SIZE * PLAINTEXT_BLOCK_SIZE; i++) Gt[i] = rand() & 1;
+        for (int i = 0; i < KEY_SIZE; i++)        K[i] = rand() & 1;
+        for (int i = 0; i < CIPHERTEXT_SIZE; i++) s[i] = rand() & 1;
+        for (size_t i = 0; i < sizeof pt; i++)    pt[i] = (uint8_t)rand();
+
+        // 임의 크기 조각으로 밀어 넣기
+        gt_encoder_t *enc = malloc(sizeof *enc);
+        gt_encoder_init(enc, Gt);
+        encrypt_stream_t st;
+        uint32_t first = 9867;
+        encrypt_stream_init(&st, K, first, s, enc);
+        size_t in = 0, out = 0;
+        while (in < sizeof pt) {
+            size_t chunk = (size_t)(rand() % 57);
+            if (chunk > sizeof pt - in) chunk = sizeof pt - in;
+            out += encrypt_stream_update(&st, pt + in, chunk, ct + out);
+            in  += chunk;
+        }
+        out += encrypt_stream_final(&st, ct + out);
+        free(enc);
+        if (out != sizeof ct) {
+            printf("FAILED: stream wrote %zu bytes, expected %zu\n", out, sizeof ct);
+            return 1;
+        }
+
+        // 블록별 기준값: lfsr_enc_m4ri keystream ⊕ p·Gt ⊕ s
+        for (int b = 0; b < NBLK; b++) {
+            int N[NONCE_SIZE], z[CIPHERTEXT_SIZE];
+            for (int j = 0; j < NONCE_SIZE; j++) N[j] = ((first + b) >> j) & 1;
+            lfsr_enc_m4ri(K, N, z);
+            for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
+                int e = 0;
+                for (int k = 0; k < PLAINTEXT_BLOCK_SIZE; k++) {
+                    size_t byte = (size_t)b * ENC_PT_BLOCK_BYTES + k / 8;
+                    int p = byte < sizeof pt ? (pt[byte] >> (7 - k % 8)) & 1 : 0;
+                    e ^= Gt[j * PLAINTEXT_BLOCK_SIZE + k] & p;
+                }
+                int c = (ct[b * ENC_CT_BLOCK_BYTES + j / 8] >> (7 - j % 8)) & 1;
+                if (c != (e ^ z[j] ^ s[j])) {
+                    printf("FAILED: block %d bit %d mismatch\n", b, j);
+                    return 1;
+                }
+            }
+        }
+    }
+    printf("SUCCESS: 40 blocks match per-block reference\n");
+
+    printf("Step 8: Testing packed encoder against bitwise p*Gt...\n");
+    {
+        enum { NBLK = 100 };
+        static int Gt[CIPHERTEXT_SIZE * PLAINTEXT_BLOCK_SIZE];
+        static uint8_t pt[NBLK * ENC_PT_BLOCK_BYTES];
+        for (int i = 0; i < CIPHERTEXT_SIZE * PLAINTEXT_BLOCK_SIZE; i++) Gt[i] = rand() & 1;
+        for (size_t i = 0; i < sizeof pt; i++) pt[i] = (uint8_t)rand();
+
+        gt_encoder_t *enc = malloc(sizeof *enc);
+        gt_encoder_init(enc, Gt);
+        mzd_t *E = mzd_init(NBLK, CIPHERTEXT_SIZE);
+        gt_encode_batch(enc, pt, NBLK, E);
+        for (int b = 0; b < NBLK; b++) {
+            word e[KEYSTREAM_WORDS];
+            gt_encode_block(enc, pt + b * ENC_PT_BLOCK_BYTES, e);
+            for (int j = 0; j < CIPHERTEXT_SIZE; j++) {
+                int ref = 0;
+                for (int k = 0; k < PLAINTEXT_BLOCK_SIZE; k++) {
+                    ref ^= Gt[j * PLAINTEXT_BLOCK_SIZE + k] & (pt[b * ENC_PT_BLOCK_BYTES + k / 8] >> (7 - k % 8));
+                }
+                if ((int)((e[j / 64] >> (j % 64)) & 1) != (ref & 1) ||
+                    mzd_read_bit(E, b, j) != (ref & 1)) {
+                    printf("FAILED: codeword mismatch at block %d bit %d\n", b, j);
+                    return 1;
+                }
+            }
+        }
+        mzd_free(E);
+        free(enc);
+    }
+    printf("SUCCESS: 100 blocks match, batch == per-block\n");
+
+    printf("Step 9: Cleanup...\n");
     mzd_free(R1);
     mzd_free(R2);
     mzd_free(R3);
@@ -1,203 +1,257 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdint.h> 
+#include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include "lfsr_state.h"        // lfsr_matrices_init, lfsr_matrix_initialization_regs
 #include "encrypt.h"
-#include "decrypt.h"            // init_globals_for_r4
-#include "error_bits.h"         // generate_error_configs, populate_error_config_syndromes
+#include "decrypt.h"            // init_globals_core
+#include "error_bits.h"         // error_configs_init
+#include "r4_sweep.h"           // r4_sweep_run
+#include "r4_result.h"          // r4_result_write, r4_shard_range
+#include "ctht_cache.h"         // ctht_lru_t
 
 
-/**
- * @brief   Test whether any error‐bit configuration for a given R4 is solvable.
- * @param   R4        The R4 index to check (0 … R4_SPACE−1).
- * @param   configs   Fully populated error_config_list_t (with syndromes).
- * @return            true iff at least one configuration in configs for this R4 yields a solution.
- */
+static void print_progress(size_t current, size_t total) {
+    const int BAR_WIDTH = 50;
+    float fraction = (float)current / (float)total;
+    int filled = (int)(fraction * BAR_WIDTH);
 
+    printf("\r[");
+    for (int i = 0; i < BAR_WIDTH; ++i) {
+        putchar(i < filled ? '=' : ' ');
+    }
+    printf("] %3zu/%3zu", current, total);
+    fflush(stdout);
+}
 
-bool is_invalid_r4(uint16_t R4,
-                 const error_config_list_t *configs){
+typedef struct {
+    uint32_t lo;
+    size_t   total;
+} progress_t;
 
-    // 1) fast‐init only this R4
-    if (CtHt_cache[R4] == NULL) {
-        printf("warning: R4 %d not initialized      .\n", R4);
-        init_globals_for_r4(R4);
-        printf("warning: R4 %d initialized successfully.\n", R4);
+// sweep 엔진이 R4 오름차순으로 호출
+static void on_r4_result(uint16_t r4, r4_status_t status, void *user) {
+    const progress_t *p = user;
+    if (status == R4_INVALID) {
+        printf("\n  ❌ R4 = %u\n", r4);
+    } else if (status == R4_VALID) {
+        printf("\n  ✅ R4 = %u\n", r4);
     }
-   
-    // 2) build per‐block system once
-    mzd_t *A_list[NUM_BLOCKS];
-    mzd_t *b_base[NUM_BLOCKS];
-    assemble_system(R4, A_list, b_base);
-
-    for (int unknown1 = 0; unknown1 < NUM_BLOCKS; ++unknown1) {
-        for (int unknown2 = unknown1 + 1; unknown2 < NUM_BLOCKS; ++unknown2) {
-            // assemble large A and prepare solver
-            mzd_t *A_large = NULL;
-            assemble_A_for_unknowns_2_input  (A_list, unknown1, unknown2, &A_large);
-            solver_ctx_t *ctx = solver_prepare(A_large);
-                // build b by stacking per-block segments
-                mzd_t *b = NULL;
-                for (int j = 0; j < NUM_BLOCKS; ++j) {
-                    if (j == unknown1 || j == unknown2) continue;
-                    mzd_t *seg = mzd_copy(NULL, b_base[j]);
-                    if (!b) {
-                        b = seg;
-                    } else {
-                        mzd_t *tmp = mzd_stack(NULL, b, seg);
-                        mzd_free(b);
-                        mzd_free(seg);
-                        b = tmp;
-                    }
-                }
-                assert(b);
-
-                // check solvability
-                bool solvable = solver_check(ctx, b);
-                mzd_free(b);
-                if (solvable) {
-                    // cleanup and return false
-                    solver_free(ctx);
-                    mzd_free(A_large);
-                    for (int k = 0; k < NUM_BLOCKS; ++k) {
-                        mzd_free(A_list[k]);
-                        mzd_free(b_base[k]);
-                    }
-                    return false;
-                }
-            
-
-            mzd_free(A_large);
-        }
+    print_progress((size_t)(r4 - p->lo) + 1, p->total);
+}
 
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--threads N] [--r4-range lo:hi | --shard i/n] [--out result.bin]\n"
+            "          [--checkpoint file [--checkpoint-interval SEC] [--resume]]\n"
+            "          [--ctht-cache file | --ctht-capacity N]\n",
+            prog);
+}
 
-    }
+// "a<sep>b" 형식의 두 정수를 파싱
+static bool parse_pair(const char *s, char sep, uint32_t *a, uint32_t *b) {
+    char *endptr;
+    unsigned long x = strtoul(s, &endptr, 0);
+    if (endptr == s || *endptr != sep) return false;
+    const char *t = endptr + 1;
+    unsigned long y = strtoul(t, &endptr, 0);
+    if (endptr == t || *endptr != '\0') return false;
+    if (x > R4_SPACE || y > R4_SPACE) return false;
+    *a = (uint32_t)x;
+    *b = (uint32_t)y;
     return true;
 }
 
-bool is_valid_r4(uint16_t R4,
-                 const error_config_list_t *configs)
-{
-    // 1) fast‐init only this R4
-    if (CtHt_cache[R4] == NULL) {
-        printf("warning: R4 %d not initialized      .\n", R4);
-        init_globals_for_r4(R4);
-        printf("warning: R4 %d initialized successfully.\n", R4);
-    }
-   
-
-    // 2) build per‐block system once
-    mzd_t *A_list[NUM_BLOCKS];
-    mzd_t *b_base[NUM_BLOCKS];
-    assemble_system(R4, A_list, b_base);
-
-    // 3) how many configs per unknown block
-    size_t segment = 1 + (NUM_BLOCKS - 1) * CIPHERTEXT_SIZE;
-
-    // 4) for each unknown block
-    for (int unknown = 0; unknown < NUM_BLOCKS; ++unknown) {
-        // assemble large A and prepare solver
-        mzd_t *A_large = NULL;
-        assemble_A_for_unknown(A_list, unknown, &A_large);
-        solver_ctx_t *ctx = solver_prepare(A_large);
-
-        // test each config in this unknown’s segment
-        size_t start = unknown * segment;
-        size_t end   = start + segment;
-        for (size_t idx = start; idx < end; ++idx) {
-            const error_bits_t *cfg = &configs->list[idx];
-
-            // build b by stacking per‐block segments
-            mzd_t *b = NULL;
-            for (int j = 0; j < NUM_BLOCKS; ++j) {
-                if (j == unknown) continue;
-                mzd_t *seg = mzd_copy(NULL, b_base[j]);
-                if (cfg->blocks[j].status == BLOCK_ERROR_KNOWN_POS) {
-                    mzd_add(seg, seg, cfg->blocks[j].syndrome);
-                }
-                if (!b) {
-                    b = seg;
-                } else {
-                    mzd_t *tmp = mzd_stack(NULL, b, seg);
-                    mzd_free(b);
-                    mzd_free(seg);
-                    b = tmp;
-                }
+int main(int argc, char *argv[]) {
+    int         nthreads = 0;   // 0 = 온라인 코어 수
+    uint32_t    lo = 0, hi = R4_SPACE;
+    bool        sharded  = false;
+    const char *out_path = NULL;
+    char        default_out[64];
+    const char *ckpt_path = NULL;
+    unsigned    ckpt_secs = 0;   // 0 = R4_SWEEP_CHECKPOINT_SECS
+    bool        resume    = false;
+    const char *ctht_path = NULL;
+    uint32_t    ctht_cap  = 0;   // 0 = 전역 CtHt_cache[] (R4_SPACE 항목)
+
+    for (int i = 1; i < argc; ++i) {
+        if ((strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-j") == 0) && i + 1 < argc) {
+            char *endptr;
+            long n = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n < 0) {
+                fprintf(stderr, "Invalid thread count: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            nthreads = (int)n;
+        } else if (strcmp(argv[i], "--r4-range") == 0 && i + 1 < argc) {
+            if (!parse_pair(argv[++i], ':', &lo, &hi) || lo >= hi) {
+                fprintf(stderr, "Invalid R4 range: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            sharded = true;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            uint32_t si, sn;
+            if (!parse_pair(argv[++i], '/', &si, &sn) ||
+                r4_shard_range(si, sn, &lo, &hi) != 0) {
+                fprintf(stderr, "Invalid shard: %s\n", argv[i]);
+                return EXIT_FAILURE;
             }
-            assert(b);
-
-            // check solvability
-            bool solvable = solver_check(ctx, b);
-            mzd_free(b);
-            if (solvable) {
-                // cleanup and return true
-                solver_free(ctx);
-                mzd_free(A_large);
-                for (int k = 0; k < NUM_BLOCKS; ++k) {
-                    mzd_free(A_list[k]);
-                    mzd_free(b_base[k]);
-                }
-                return true;
+            sharded = true;
+        } else if ((strcmp(argv[i], "--out") == 0 || strcmp(argv[i], "-o") == 0) && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            ckpt_path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            char *endptr;
+            long n = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n <= 0) {
+                fprintf(stderr, "Invalid checkpoint interval: %s\n", argv[i]);
+                return EXIT_FAILURE;
             }
+            ckpt_secs = (unsigned)n;
+        } else if (strcmp(argv[i], "--ctht-cache") == 0 && i + 1 < argc) {
+            ctht_path = argv[++i];
+        } else if (strcmp(argv[i], "--ctht-capacity") == 0 && i + 1 < argc) {
+            char *endptr;
+            unsigned long n = strtoul(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n == 0 || n > R4_SPACE) {
+                fprintf(stderr, "Invalid CtHt capacity: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            ctht_cap = (uint32_t)n;
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = true;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
+    }
+    if (resume && !ckpt_path) {
+        fprintf(stderr, "--resume requires --checkpoint\n");
+        return EXIT_FAILURE;
+    }
+    if (ctht_path && ctht_cap) {
+        fprintf(stderr, "--ctht-cache and --ctht-capacity are mutually exclusive\n");
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *status = calloc(R4_SPACE, 1);
+    if (!status) abort();
 
-        // cleanup per‐unknown
-        solver_free(ctx);
-        mzd_free(A_large);
+    // 재개: checkpoint가 있으면 완료된 R4와 결과를 불러옴 (없으면 처음부터)
+    struct stat st;
+    bool     resumed = false;
+    uint64_t ckpt_fp = 0;
+    if (resume && stat(ckpt_path, &st) == 0) {
+        uint32_t clo, chi;
+        if (r4_result_read(ckpt_path, &clo, &chi, &ckpt_fp, status) != 0) {
+            free(status);
+            return EXIT_FAILURE;
+        }
+        if (sharded && (clo != lo || chi != hi)) {
+            fprintf(stderr, "Checkpoint %s covers [%u, %u), not [%u, %u)\n",
+                    ckpt_path, clo, chi, lo, hi);
+            free(status);
+            return EXIT_FAILURE;
+        }
+        lo = clo;
+        hi = chi;
+        size_t done = 0;
+        for (uint32_t r4 = lo; r4 < hi; ++r4) done += status[r4] != R4_PENDING;
+        printf("Resuming from %s: %zu/%u done\n", ckpt_path, done, hi - lo);
+        resumed = true;
+    } else if (resume && errno != ENOENT) {
+        perror(ckpt_path);
+        free(status);
+        return EXIT_FAILURE;
     }
 
-    // 5) cleanup and return false
-    for (int i = 0; i < NUM_BLOCKS; ++i) {
-        mzd_free(A_list[i]);
-        mzd_free(b_base[i]);
+    // 구간 모드에서는 결과 파일이 기본으로 남도록 함 (merge_r4_shards 입력)
+    if (sharded && !out_path) {
+        snprintf(default_out, sizeof default_out, "r4_%05u_%05u.bin", lo, hi);
+        out_path = default_out;
     }
-    return false;
-}
 
+    // 1) Shared syndrome table for all candidate error configurations
+    error_config_list_t configs;
+    error_configs_init(&configs);
 
-static void print_progress(size_t current, size_t total) {
-    const int BAR_WIDTH = 50;
-    float fraction = (float)current / (float)total;
-    int filled = (int)(fraction * BAR_WIDTH);
+    // 2) Initialize shared globals once; CtHt_cache[R4] is built lazily by the workers
+    init_globals_core();
+    if (ctht_path && init_CtHt_cache_from_file(ctht_path) != 0) {
+        fprintf(stderr, "CtHt cache %s unusable, building entries on demand\n", ctht_path);
+    }
 
-    printf("\r[");
-    for (int i = 0; i < BAR_WIDTH; ++i) {
-        putchar(i < filled ? '=' : ' ');
+    // 다른 암호문/scramble 로 만든 checkpoint 의 판정은 섞지 않음
+    const uint64_t fingerprint = r4_result_global_fingerprint();
+    if (resumed && ckpt_fp != fingerprint) {
+        fprintf(stderr, "Checkpoint %s was made from a different capture "
+                "(fingerprint %016llx, current %016llx)\n", ckpt_path,
+                (unsigned long long)ckpt_fp, (unsigned long long)fingerprint);
+        free(status);
+        return EXIT_FAILURE;
     }
-    printf("] %3zu/%3zu", current, total);
-    fflush(stdout);
-}
 
-int main(void) {
-    // 1) Generate and populate all candidate error configurations once
-    error_config_list_t configs;
-    generate_error_configs(&configs);
-    populate_error_config_syndromes(&configs);
-    init_globals();
-
-    // 2) Initialize globals once (no R4 yet)
-    // We want lazy per‐R4 init inside is_valid_r4, so here nothing
-
-    // 3) Iterate over all R4 indices and test validity with progress bar
-    printf("Valid R4 candidates:\n");
-    size_t total = (size_t)R4_SPACE;
-    for (size_t r4 = 0; r4 < total; ++r4) {
-        print_progress(r4, total);
-        if (is_invalid_r4((uint16_t)r4, &configs)) {
-            printf("\n  ❌ R4 = %zu\n", r4);
-       
-           continue; // skip invalid R4s
-        }
-        if (is_valid_r4((uint16_t)r4, &configs)) {
-            printf("\n  ✅ R4 = %zu\n", r4);
+    // 메모리 상한이 주어지면 최근 ctht_cap 개의 CtHt만 유지 (나머지는 다시 계산)
+    ctht_lru_t  lru;
+    ctht_lru_t *ctht = NULL;
+    if (ctht_cap) {
+        if (ctht_lru_init(&lru, ctht_cap, CtHt_fill_entry, NULL) != 0) {
+            free(status);
+            return EXIT_FAILURE;
         }
+        ctht = &lru;
+    }
+
+    // 3) Sweep [lo, hi) in parallel; results arrive in R4 order
+    printf("Valid R4 candidates in [%u, %u):\n", lo, hi);
+    progress_t progress = { .lo = lo, .total = (size_t)(hi - lo) };
+    size_t total = progress.total;
+
+    r4_sweep_opts_t opts = {
+        .lo        = lo,
+        .hi        = hi,
+        .nthreads  = nthreads,
+        .configs   = &configs,
+        .on_result = on_r4_result,
+        .user      = &progress,
+        .checkpoint_path = ckpt_path,
+        .checkpoint_secs = ckpt_secs,
+        .fingerprint     = fingerprint,
+        .ctht      = ctht,
+    };
+    print_progress(0, total);
+    int sweep_rc = r4_sweep_run(&opts, status);
+    if (sweep_rc != 0) {
+        fprintf(stderr, "\nR4 sweep failed\n");
+        if (ctht) ctht_lru_free(ctht);
+        free(status);
+        return EXIT_FAILURE;
     }
     // finish bar
     print_progress(total, total);
     printf("\nDone.\n");
+    if (ctht) {
+        ctht_lru_stats_t cs;
+        ctht_lru_get_stats(ctht, &cs);
+        printf("CtHt cache (%u entries): %llu hits, %llu misses, %llu evictions\n",
+               ctht_cap, (unsigned long long)cs.hits,
+               (unsigned long long)cs.misses, (unsigned long long)cs.evictions);
+        ctht_lru_free(ctht);
+    }
+
+    if (out_path) {
+        if (r4_result_write(out_path, lo, hi, fingerprint, status) != 0) {
+            free(status);
+            return EXIT_FAILURE;
+        }
+        printf("Results for [%u, %u) written to %s\n", lo, hi, out_path);
+    }
 
     // 4) Cleanup
-    free(configs.list);
+    free(status);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,284 @@
+// find_r4_batch.c — 여러 캡처에 대한 R4 sweep 을 한 프로세스에서
+//
+// 캡처 목록(--manifest 또는 --dir)을 CAPTURE_BATCH_MAX 개씩 묶어 묶음마다 sweep 을 한 번
+// 돌립니다. R4 마다 CtHt 와 전체 시스템 소거는 묶음 안의 모든 캡처가 나눠 쓰고, CtHt 캐시
+// (전역 CtHt_cache[], --ctht-cache, --ctht-capacity) 는 묶음 사이에도 그대로 남습니다.
+// 다음 묶음의 파일 읽기와 c·Ht 계산은 loader 스레드가 현재 묶음의 sweep 과 겹쳐서 합니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "decrypt.h"            // init_globals_shared
+#include "error_bits.h"         // error_configs_init
+#include "r4_sweep.h"           // r4_sweep_run
+#include "r4_result.h"          // r4_result_write
+#include "ctht_cache.h"         // ctht_lru_t
+#include "capture.h"            // capture_list_t, capture_batch_t
+
+/* loader ↔ sweep 사이의 묶음 두 칸 (double buffering) */
+typedef struct {
+    const capture_list_t *list;
+    size_t           group;      // 묶음당 캡처 수
+    size_t           ngroups;
+
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    capture_batch_t  slot[2];
+    bool             full[2];    // slot 에 아직 sweep 하지 않은 묶음이 있음
+    int              skipped;    // 읽지 못한 캡처 수 (lock 으로 보호)
+} loader_t;
+
+static void *loader_main(void *arg) {
+    loader_t *ld = arg;
+    for (size_t g = 0; g < ld->ngroups; ++g) {
+        int k = (int)(g % 2);
+        pthread_mutex_lock(&ld->lock);
+        while (ld->full[k]) pthread_cond_wait(&ld->cond, &ld->lock);
+        pthread_mutex_unlock(&ld->lock);
+
+        // sweep 쪽은 full[k] 가 설 때까지 slot[k] 를 읽지 않으므로 잠금 밖에서 채움
+        int skipped = capture_batch_load(&ld->slot[k], ld->list, g * ld->group, ld->group);
+
+        pthread_mutex_lock(&ld->lock);
+        ld->full[k]  = true;
+        ld->skipped += skipped;
+        pthread_cond_broadcast(&ld->cond);
+        pthread_mutex_unlock(&ld->lock);
+    }
+    return NULL;
+}
+
+static double now_secs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s (--manifest file | --dir captures/) [--scramble s.bin] [--out-dir dir]\n"
+            "          [--threads N] [--r4-range lo:hi] [--group N]\n"
+            "          [--ctht-cache file | --ctht-capacity N]\n",
+            prog);
+}
+
+static bool parse_range(const char *s, uint32_t *a, uint32_t *b) {
+    char *endptr;
+    unsigned long x = strtoul(s, &endptr, 0);
+    if (endptr == s || *endptr != ':') return false;
+    const char *t = endptr + 1;
+    unsigned long y = strtoul(t, &endptr, 0);
+    if (endptr == t || *endptr != '\0') return false;
+    if (x >= y || y > R4_SPACE) return false;
+    *a = (uint32_t)x;
+    *b = (uint32_t)y;
+    return true;
+}
+
+// 결과 파일 이름: <out_dir>/<목록 번호>_<암호문 파일 이름에서 .bin 을 뺀 것>.r4.bin
+static void result_path(char *dst, size_t len, const char *out_dir, size_t index,
+                        const char *cipher_path)
+{
+    const char *base = strrchr(cipher_path, '/');
+    base = base ? base + 1 : cipher_path;
+    size_t n = strlen(base);
+    if (n >= 4 && strcmp(base + n - 4, ".bin") == 0) n -= 4;
+    snprintf(dst, len, "%s/%05zu_%.*s.r4.bin", out_dir, index, (int)n, base);
+}
+
+int main(int argc, char *argv[]) {
+    const char *manifest  = NULL;
+    const char *dir       = NULL;
+    const char *scramble  = SCRAMBLE_PATH;
+    const char *out_dir   = ".";
+    int         nthreads  = 0;
+    uint32_t    lo = 0, hi = R4_SPACE;
+    size_t      group     = CAPTURE_BATCH_MAX;
+    const char *ctht_path = NULL;
+    uint32_t    ctht_cap  = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            manifest = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (strcmp(argv[i], "--scramble") == 0 && i + 1 < argc) {
+            scramble = argv[++i];
+        } else if (strcmp(argv[i], "--out-dir") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if ((strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-j") == 0) && i + 1 < argc) {
+            char *endptr;
+            long n = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n < 0) {
+                fprintf(stderr, "Invalid thread count: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            nthreads = (int)n;
+        } else if (strcmp(argv[i], "--r4-range") == 0 && i + 1 < argc) {
+            if (!parse_range(argv[++i], &lo, &hi)) {
+                fprintf(stderr, "Invalid R4 range: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--group") == 0 && i + 1 < argc) {
+            char *endptr;
+            unsigned long n = strtoul(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n == 0 || n > CAPTURE_BATCH_MAX) {
+                fprintf(stderr, "Invalid group size: %s (1..%d)\n", argv[i], CAPTURE_BATCH_MAX);
+                return EXIT_FAILURE;
+            }
+            group = n;
+        } else if (strcmp(argv[i], "--ctht-cache") == 0 && i + 1 < argc) {
+            ctht_path = argv[++i];
+        } else if (strcmp(argv[i], "--ctht-capacity") == 0 && i + 1 < argc) {
+            char *endptr;
+            unsigned long n = strtoul(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || n == 0 || n > R4_SPACE) {
+                fprintf(stderr, "Invalid CtHt capacity: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            ctht_cap = (uint32_t)n;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!manifest == !dir) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (ctht_path && ctht_cap) {
+        fprintf(stderr, "--ctht-cache and --ctht-capacity are mutually exclusive\n");
+        return EXIT_FAILURE;
+    }
+
+    // 1) 캡처 목록 (경로만; 파일은 loader 가 묶음 단위로 읽음)
+    capture_list_t list = {0};
+    int rc = manifest ? capture_list_from_manifest(&list, manifest, scramble)
+                      : capture_list_from_dir(&list, dir, scramble);
+    if (rc != 0 || list.n == 0) {
+        fprintf(stderr, "No captures in %s\n", manifest ? manifest : dir);
+        capture_list_free(&list);
+        return EXIT_FAILURE;
+    }
+    struct stat st;
+    if (stat(out_dir, &st) != 0 && mkdir(out_dir, 0777) != 0 && errno != EEXIST) {
+        perror(out_dir);
+        capture_list_free(&list);
+        return EXIT_FAILURE;
+    }
+
+    // 2) 캡처와 무관한 전역 상태와 CtHt 캐시는 한 번만
+    error_config_list_t configs;
+    error_configs_init(&configs);
+    init_globals_shared();
+    if (ctht_path && init_CtHt_cache_from_file(ctht_path) != 0) {
+        fprintf(stderr, "CtHt cache %s unusable, building entries on demand\n", ctht_path);
+    }
+    ctht_lru_t  lru;
+    ctht_lru_t *ctht = NULL;
+    if (ctht_cap) {
+        if (ctht_lru_init(&lru, ctht_cap, CtHt_fill_entry, NULL) != 0) {
+            capture_list_free(&list);
+            return EXIT_FAILURE;
+        }
+        ctht = &lru;
+    }
+
+    // 3) loader 스레드: 묶음 g+1 을 읽는 동안 묶음 g 를 sweep
+    loader_t *ld = calloc(1, sizeof *ld);
+    uint8_t  *status     = malloc(R4_SPACE);
+    uint8_t  *cap_status = malloc((size_t)CAPTURE_BATCH_MAX * R4_SPACE);
+    if (!ld || !status || !cap_status) abort();
+    ld->list    = &list;
+    ld->group   = group;
+    ld->ngroups = (list.n + group - 1) / group;
+    pthread_mutex_init(&ld->lock, NULL);
+    pthread_cond_init(&ld->cond, NULL);
+    pthread_t loader;
+    if (pthread_create(&loader, NULL, loader_main, ld) != 0) {
+        fprintf(stderr, "pthread_create failed for loader\n");
+        abort();
+    }
+
+    printf("%zu captures in %zu groups, R4 in [%u, %u)\n", list.n, ld->ngroups, lo, hi);
+    int failed = 0;
+    for (size_t g = 0; g < ld->ngroups; ++g) {
+        int k = (int)(g % 2);
+        pthread_mutex_lock(&ld->lock);
+        while (!ld->full[k]) pthread_cond_wait(&ld->cond, &ld->lock);
+        pthread_mutex_unlock(&ld->lock);
+        const capture_batch_t *batch = &ld->slot[k];
+
+        double t0 = now_secs();
+        if (batch->n > 0) {
+            memset(status, R4_PENDING, R4_SPACE);
+            memset(cap_status, R4_PENDING, (size_t)batch->n * R4_SPACE);
+            r4_sweep_opts_t opts = {
+                .lo       = lo,
+                .hi       = hi,
+                .nthreads = nthreads,
+                .configs  = &configs,
+                .ctht     = ctht,
+                .captures = batch,
+                .capture_status = cap_status,
+            };
+            if (r4_sweep_run(&opts, status) != 0) {
+                fprintf(stderr, "R4 sweep failed for group %zu\n", g);
+                abort();
+            }
+        }
+        printf("Group %zu/%zu: %d captures in %.1f s\n",
+               g + 1, ld->ngroups, batch->n, now_secs() - t0);
+
+        for (int c = 0; c < batch->n; ++c) {
+            size_t         idx = batch->index[c];
+            const uint8_t *cs  = cap_status + (size_t)c * R4_SPACE;
+            size_t n_valid = 0, n_invalid = 0;
+            for (uint32_t r4 = lo; r4 < hi; ++r4) {
+                n_valid   += cs[r4] == R4_VALID;
+                n_invalid += cs[r4] == R4_INVALID;
+            }
+            char path[4096];
+            result_path(path, sizeof path, out_dir, idx, list.cipher[idx]);
+            if (r4_result_write(path, lo, hi, r4_result_fingerprint(batch->cht[c]), cs) != 0) {
+                failed++;
+                continue;
+            }
+            printf("  %s: %zu valid, %zu invalid → %s\n",
+                   list.cipher[idx], n_valid, n_invalid, path);
+        }
+
+        // slot 을 비워 loader 가 다음다음 묶음을 읽게 함
+        pthread_mutex_lock(&ld->lock);
+        ld->full[k] = false;
+        pthread_cond_broadcast(&ld->cond);
+        pthread_mutex_unlock(&ld->lock);
+    }
+    pthread_join(loader, NULL);
+    failed += ld->skipped;
+
+    if (ctht) {
+        ctht_lru_stats_t cs;
+        ctht_lru_get_stats(ctht, &cs);
+        printf("CtHt cache (%u entries): %llu hits, %llu misses, %llu evictions\n",
+               ctht_cap, (unsigned long long)cs.hits,
+               (unsigned long long)cs.misses, (unsigned long long)cs.evictions);
+        ctht_lru_free(ctht);
+    }
+    printf("Done: %zu captures, %d failed\n", list.n, failed);
+
+    // 4) Cleanup
+    pthread_cond_destroy(&ld->cond);
+    pthread_mutex_destroy(&ld->lock);
+    free(ld);
+    free(status);
+    free(cap_status);
+    capture_list_free(&list);
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,176 @@
+// r4_result_test.c — 결과/checkpoint 파일 입출력과 sweep 재개 확인
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "decrypt.h"            // init_globals_core
+#include "error_bits.h"         // error_configs_init
+#include "r4_result.h"
+#include "r4_sweep.h"
+
+#define TEST_PATH  "r4_result_test.bin"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "FAILED: " __VA_ARGS__);            \
+            fprintf(stderr, "\n");                              \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(*len);
+    if (fread(buf, 1, *len, f) != *len) abort();
+    fclose(f);
+    return buf;
+}
+
+static void write_file(const char *path, const uint8_t *buf, size_t len) {
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(buf, 1, len, f) != len) abort();
+    fclose(f);
+}
+
+// 1) 전체 결과 / checkpoint 를 쓰고 읽어 status 와 fingerprint 가 그대로인지
+static void check_round_trip(void) {
+    const uint32_t lo = 1000, hi = 1300;
+    const uint64_t fp = 0x0123456789abcdefULL;
+    uint8_t *st  = calloc(R4_SPACE, 1);
+    uint8_t *got = calloc(R4_SPACE, 1);
+    for (uint32_t r4 = lo; r4 < hi; ++r4) st[r4] = (uint8_t)(R4_NONE + rand() % 3);
+
+    uint32_t rlo, rhi;
+    uint64_t rfp;
+    CHECK(r4_result_write(TEST_PATH, lo, hi, fp, st) == 0, "write");
+    CHECK(r4_result_read(TEST_PATH, &rlo, &rhi, &rfp, got) == 0, "read");
+    CHECK(rlo == lo && rhi == hi && rfp == fp, "header round trip");
+    CHECK(memcmp(st + lo, got + lo, hi - lo) == 0, "status round trip");
+
+    // 미완료가 남은 status 는 전체 결과로 쓸 수 없고, checkpoint 로는 bitmap 에 0 으로 남음
+    for (uint32_t r4 = lo; r4 < hi; r4 += 3) st[r4] = R4_PENDING;
+    CHECK(r4_result_write(TEST_PATH, lo, hi, fp, st) != 0, "write with pending must fail");
+    CHECK(r4_result_write_checkpoint(TEST_PATH, lo, hi, fp, st) == 0, "write checkpoint");
+    memset(got, 0xff, R4_SPACE);
+    CHECK(r4_result_read(TEST_PATH, &rlo, &rhi, &rfp, got) == 0, "read checkpoint");
+    CHECK(memcmp(st + lo, got + lo, hi - lo) == 0, "partial bitmap round trip");
+    CHECK(got[lo - 1] == 0xff && got[hi] == 0xff, "read touched R4 outside the range");
+
+    free(st);
+    free(got);
+    printf("Round trip check: %s\n", failures ? "FAILED" : "OK");
+}
+
+// 2) body, fingerprint, version 중 한 바이트라도 바뀌면 읽기를 거부
+static void check_corruption(void) {
+    int before = failures;
+    uint8_t *st = calloc(R4_SPACE, 1);
+    for (uint32_t r4 = 0; r4 < 64; ++r4) st[r4] = r4 % 5 ? R4_INVALID : R4_VALID;
+    CHECK(r4_result_write_checkpoint(TEST_PATH, 0, 64, 42, st) == 0, "write checkpoint");
+
+    size_t   len;
+    uint8_t *orig = read_file(TEST_PATH, &len);
+    static const size_t offsets[] = { 4, 24, 31, 36, 44 };   // version, fingerprint, bitmap, 목록
+    for (size_t k = 0; k < sizeof offsets / sizeof offsets[0]; ++k) {
+        uint8_t *bad = malloc(len);
+        memcpy(bad, orig, len);
+        bad[offsets[k]] ^= 0x01;
+        write_file(TEST_PATH, bad, len);
+        uint32_t lo, hi;
+        CHECK(r4_result_read(TEST_PATH, &lo, &hi, NULL, st) != 0,
+              "corrupted byte %zu accepted", offsets[k]);
+        free(bad);
+    }
+    write_file(TEST_PATH, orig, len - 1);
+    uint32_t lo, hi;
+    CHECK(r4_result_read(TEST_PATH, &lo, &hi, NULL, st) != 0, "truncated file accepted");
+
+    free(orig);
+    free(st);
+    printf("Corruption check: %s\n", failures > before ? "FAILED" : "OK");
+}
+
+typedef struct {
+    uint32_t next;      // 다음에 와야 할 R4
+    uint32_t calls;
+    bool     ordered;
+} emit_log_t;
+
+static void on_result(uint16_t r4, r4_status_t status, void *user) {
+    emit_log_t *log = user;
+    log->ordered &= r4 == log->next && status != R4_PENDING;
+    log->next = r4 + 1u;
+    log->calls++;
+}
+
+// 3) checkpoint 에서 재개하면 끝난 R4 는 다시 판정하지 않고, 마지막 checkpoint 는 완결
+static void check_resume(void) {
+    int before = failures;
+    init_globals_core();
+    error_config_list_t configs;
+    error_configs_init(&configs);
+    const uint64_t fp = r4_result_global_fingerprint();
+    const uint32_t lo = 200, hi = 1200;
+
+    // 짝수 R4 는 끝난 것으로: 실제 판정과 다른 값이 남아 있으면 다시 계산하지 않은 것
+    uint8_t *st = calloc(R4_SPACE, 1);
+    for (uint32_t r4 = lo; r4 < hi; r4 += 2) st[r4] = R4_VALID;
+    CHECK(r4_result_write_checkpoint(TEST_PATH, lo, hi, fp, st) == 0, "write checkpoint");
+    memset(st, 0, R4_SPACE);
+    uint32_t rlo, rhi;
+    uint64_t rfp;
+    CHECK(r4_result_read(TEST_PATH, &rlo, &rhi, &rfp, st) == 0 && rfp == fp, "read checkpoint");
+
+    // 여러 워커 + 1초 주기로 sweep 도중의 checkpoint 쓰기도 거침
+    emit_log_t log = { .next = lo, .ordered = true };
+    r4_sweep_opts_t opts = {
+        .lo = lo, .hi = hi, .nthreads = 2, .chunk = 4,
+        .configs = &configs, .on_result = on_result, .user = &log,
+        .checkpoint_path = TEST_PATH, .checkpoint_secs = 1, .fingerprint = fp,
+    };
+    CHECK(r4_sweep_run(&opts, st) == 0, "sweep");
+    CHECK(log.ordered && log.calls == hi - lo, "results not emitted once in R4 order");
+
+    r4_scratch_t scratch;
+    r4_scratch_init(&scratch);
+    for (uint32_t r4 = lo; r4 < hi; ++r4) {
+        if ((r4 - lo) % 2 == 0) {
+            CHECK(st[r4] == R4_VALID, "finished R4 %u was re-evaluated", r4);
+        } else if (r4 % 16 == 1) {
+            CHECK(st[r4] == r4_classify((uint16_t)r4, &configs, &scratch, NULL),
+                  "R4 %u verdict differs from r4_classify", r4);
+        } else {
+            CHECK(st[r4] != R4_PENDING, "R4 %u not evaluated", r4);
+        }
+    }
+    r4_scratch_free(&scratch);
+
+    uint8_t *fin = calloc(R4_SPACE, 1);
+    CHECK(r4_result_read(TEST_PATH, &rlo, &rhi, &rfp, fin) == 0, "read final checkpoint");
+    CHECK(rfp == fp && memcmp(fin + lo, st + lo, hi - lo) == 0, "final checkpoint differs");
+    free(fin);
+    free(st);
+    printf("Resume check: %s\n", failures > before ? "FAILED" : "OK");
+}
+
+int main(void) {
+    srand(12345);
+    check_round_trip();
+    check_corruption();
+    check_resume();
+    remove(TEST_PATH);
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All r4_result tests passed!\n");
+    return 0;
+}
@@ -5,7 +5,7 @@
 #include <assert.h>
 #include "m4ri/m4ri.h"
 #include "decrypt.h"            // init_globals_for_r4
-#include "error_bits.h"         // generate_error_configs, populate_error_config_syndromes
+#include "error_bits.h"         // error_configs_init, error_config_at
 
 /**
  * @brief   For a given R4 index, iterate through all generated error configurations,
@@ -19,10 +19,9 @@ bool process_and_save_solutions(uint16_t R4, const char *out_path) {
     // 1) fast‐init only R4
     init_globals_for_r4(R4);
 
-    // 2) generate & syndrome‐populate configs
+    // 2) shared syndrome table for all configs
     error_config_list_t configs;
-    generate_error_configs(&configs);
-    populate_error_config_syndromes(&configs);
+    error_configs_init(&configs);
 
     // 3) build per‐block system once
     mzd_t *A_list[NUM_BLOCKS], *b_base[NUM_BLOCKS];
@@ -36,14 +35,13 @@ bool process_and_save_solutions(uint16_t R4, const char *out_path) {
             mzd_free(A_list[i]);
             mzd_free(b_base[i]);
         }
-        free(configs.list);
     return false;
     }
     // write CSV header
     fprintf(f, "config_index,unknown_block,solvable\n");
 
     // 5) segment size
-    size_t segment = 1 + (NUM_BLOCKS - 1) * CIPHERTEXT_SIZE;
+    size_t segment = ERROR_CONFIG_SEGMENT;
 
     // 6) for each unknown block
     for (int unknown = 0; unknown < NUM_BLOCKS; ++unknown) {
@@ -52,37 +50,39 @@ bool process_and_save_solutions(uint16_t R4, const char *out_path) {
         assemble_A_for_unknown(A_list, unknown, &A_large);
         solver_ctx_t *ctx = solver_prepare(A_large);
 
-        // test each config in this unknown’s segment
+        // test each config in this unknown’s segment, 64 at a time (b_k = column k of B)
         size_t start = unknown * segment;
         size_t end   = start + segment;
-        for (size_t idx = start; idx < end; ++idx) {
-            error_bits_t *cfg = &configs.list[idx];
+        mzd_t *B = mzd_init(A_large->nrows, m4ri_radix);
+        for (size_t idx0 = start; idx0 < end; idx0 += m4ri_radix) {
+            size_t nb = end - idx0 < (size_t)m4ri_radix ? end - idx0 : (size_t)m4ri_radix;
 
-            // build b by stacking per-block segments
-            mzd_t *b = NULL;
+            // every column starts as the stacked per-block b
+            int seg = 0;
             for (int j = 0; j < NUM_BLOCKS; ++j) {
                 if (j == unknown) continue;
-                mzd_t *seg = mzd_copy(NULL, b_base[j]);
-                if (cfg->blocks[j].status == BLOCK_ERROR_KNOWN_POS) {
-                    mzd_add(seg, seg, cfg->blocks[j].syndrome);
+                for (int r = 0; r < H_ROWS; ++r) {
+                    mzd_row(B, seg * H_ROWS + r)[0] = mzd_read_bit(b_base[j], r, 0) ? ~(word)0 : 0;
                 }
-                if (!b) {
-                    b = seg;
-                } else {
-                    mzd_t *tmp = mzd_stack(NULL, b, seg);
-                    mzd_free(b);
-                    mzd_free(seg);
-                    b = tmp;
+                seg++;
+            }
+            // add the known block's syndrome to column k
+            for (size_t k = 0; k < nb; ++k) {
+                error_config_t cfg = error_config_at(idx0 + k);
+                if (cfg.known < 0) continue;
+                int s = cfg.known - (cfg.known > unknown);
+                for (word e = error_config_syndrome(&configs, &cfg); e; e &= e - 1) {
+                    mzd_row(B, s * H_ROWS + __builtin_ctzll(e))[0] ^= m4ri_one << k;
                 }
             }
-            assert(b);
 
             // check solvability
-            bool solvable = solver_check(ctx, b);
-            fprintf(f, "%zu,%d,%d\n", idx, unknown, solvable ? 1 : 0);
-
-            mzd_free(b);
+            word solvable = solver_check_batch(ctx, B);
+            for (size_t k = 0; k < nb; ++k) {
+                fprintf(f, "%zu,%d,%d\n", idx0 + k, unknown, (int)((solvable >> k) & 1));
+            }
         }
+        mzd_free(B);
 
         solver_free(ctx);
         mzd_free(A_large);
@@ -93,7 +93,6 @@ bool process_and_save_solutions(uint16_t R4, const char *out_path) {
         mzd_free(A_list[i]);
         mzd_free(b_base[i]);
     }
-    free(configs.list);
 
     fclose(f);
     return true;
@@ -3,14 +3,264 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <string.h>
 #include <stdbool.h>
 #include "m4ri/m4ri.h"
-#include "decrypt.h"  
+#include "decrypt.h"
+#include "error_bits.h"   // solver_prepare, solver_check_batch, r4_classify_prepared
 
 static double diff_secs(clock_t end, clock_t start) {
     return (double)(end - start) / CLOCKS_PER_SEC;
 }
 
+// solver_check_batch 가 열마다 solver_check 와 같은 답을 내는지 확인 (절반은 b = A·x)
+static void check_batch(int trials) {
+    const int m = 672, n = 655;
+    for (int t = 0; t < trials; ++t) {
+        mzd_t *A = mzd_init(m, n);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j)
+                mzd_write_bit(A, i, j, (rand() >> 8) & 1);
+        mzd_t *X = mzd_init(n, m4ri_radix);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m4ri_radix; ++j)
+                mzd_write_bit(X, i, j, (rand() >> 8) & 1);
+        mzd_t *B = mzd_mul(NULL, A, X, 0);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < m4ri_radix; j += 2)
+                mzd_write_bit(B, i, j, (rand() >> 8) & 1);   // 짝수 열은 임의의 b
+
+        solver_ctx_t *ctx = solver_prepare(A);
+        mzd_t *b = mzd_init(m, 1);
+        word expect = 0;
+        for (int j = 0; j < m4ri_radix; ++j) {
+            for (int i = 0; i < m; ++i) mzd_write_bit(b, i, 0, mzd_read_bit(B, i, j));
+            if (solver_check(ctx, b)) expect |= m4ri_one << j;
+        }
+        word got = solver_check_batch(ctx, B);
+        if (got != expect) {
+            fprintf(stderr, "Batch mismatch on trial %d\n", t);
+            abort();
+        }
+        solver_free(ctx);
+        mzd_free(A);
+        mzd_free(X);
+        mzd_free(B);
+        mzd_free(b);
+    }
+    printf("Batch check: OK (%d trials)\n", trials);
+}
+
+/*
+ * 공유 소거(r4_scratch_prepare + r4_classify_prepared)를 unknown/쌍마다 블록을 쌓아
+ * solver_prepare 로 새로 푸는 원래 방식과 비교합니다. 실제 데이터에서는 모든 R4 가
+ * INVALID 이므로, b = A·x 에 unknown 블록 교란을 심어 VALID / NONE 경로도 거치게 합니다.
+ */
+#define PLANT_CASES 6
+
+// rhs 를 쌓인 시스템 순서로 packed 행에 씀 (skip1, skip2 블록은 뺌)
+static void pack_rhs(const word T[NUM_BLOCKS], int skip1, int skip2, word *row, rci_t width) {
+    memset(row, 0, sizeof(word) * width);
+    int slot = 0;
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        if (j == skip1 || j == skip2) continue;
+        for (int i = 0; i < H_ROWS; ++i) {
+            if ((T[j] >> i) & 1) {
+                int c = slot * H_ROWS + i;
+                row[c / m4ri_radix] |= m4ri_one << (c % m4ri_radix);
+            }
+        }
+        slot++;
+    }
+}
+
+// 원래 is_invalid_r4: 105 쌍마다 13블록을 쌓아 solver_prepare
+static bool ref_invalid(const mzd_t *A_list[NUM_BLOCKS], const word T[NUM_BLOCKS]) {
+    for (int u1 = 0; u1 < NUM_BLOCKS; ++u1) {
+        for (int u2 = u1 + 1; u2 < NUM_BLOCKS; ++u2) {
+            mzd_t *A = NULL;
+            assemble_A_for_unknowns_2_input(A_list, u1, u2, &A);
+            solver_ctx_t *ctx = solver_prepare(A);
+            word row[SOLVER_MAX_ROW_WORDS];
+            pack_rhs(T, u1, u2, row, ctx->width);
+            bool ok = solver_check_row(ctx, row);
+            solver_free(ctx);
+            mzd_free(A);
+            if (ok) return false;
+        }
+    }
+    return true;
+}
+
+// 원래 is_valid_r4: unknown 마다 14블록을 쌓아 solver_prepare 하고 설정을 하나씩 검사
+static bool ref_valid(const mzd_t *A_list[NUM_BLOCKS],
+                      const error_config_list_t *configs,
+                      const word T[NUM_BLOCKS])
+{
+    for (int u = 0; u < NUM_BLOCKS; ++u) {
+        mzd_t *A = NULL;
+        assemble_A_for_unknown(A_list, u, &A);
+        solver_ctx_t *ctx = solver_prepare(A);
+        bool found = false;
+        error_config_t cfg = error_config_at((size_t)u * ERROR_CONFIG_SEGMENT);
+        do {
+            word Tc[NUM_BLOCKS], row[SOLVER_MAX_ROW_WORDS];
+            memcpy(Tc, T, sizeof Tc);
+            if (cfg.known >= 0) Tc[cfg.known] ^= error_config_syndrome(configs, &cfg);
+            pack_rhs(Tc, u, u, row, ctx->width);
+            found = solver_check_row(ctx, row);
+        } while (!found && error_config_next(&cfg) && cfg.unknown == u);
+        solver_free(ctx);
+        mzd_free(A);
+        if (found) return true;
+    }
+    return false;
+}
+
+static word rand48(void) {
+    return (((word)rand() << 32) ^ ((word)rand() << 16) ^ (word)rand()) & ((m4ri_one << H_ROWS) - 1);
+}
+
+// 케이스 c 의 블록 rhs: 0 b=A·x, 1 unknown 블록 교란, 2 교란 + known 블록 단일 비트,
+// 3 두 블록 교란, 4 세 블록 교란, 5 임의
+static void plant_cases(const mzd_t *A_list[NUM_BLOCKS],
+                        const error_config_list_t *configs,
+                        word T[PLANT_CASES][NUM_BLOCKS])
+{
+    mzd_t *x  = mzd_init(TOTAL_VARS - 1, 1);
+    for (rci_t i = 0; i < x->nrows; ++i) mzd_write_bit(x, i, 0, rand() & 1);
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        mzd_t *Ax = mzd_mul(NULL, A_list[j], x, 0);
+        word t = 0;
+        for (int i = 0; i < H_ROWS; ++i) t |= (word)mzd_read_bit(Ax, i, 0) << i;
+        for (int c = 0; c < PLANT_CASES; ++c) T[c][j] = t;
+        mzd_free(Ax);
+    }
+    mzd_free(x);
+
+    int u1 = rand() % NUM_BLOCKS;
+    int u2 = (u1 + 1 + rand() % (NUM_BLOCKS - 1)) % NUM_BLOCKS;
+    int u3 = (u2 + 1 + rand() % (NUM_BLOCKS - 1)) % NUM_BLOCKS;
+    while (u3 == u1) u3 = (u3 + 1) % NUM_BLOCKS;
+    T[1][u1] ^= rand48();
+    T[2][u1] ^= rand48();
+    T[2][u2] ^= configs->syndrome[rand() % CIPHERTEXT_SIZE];
+    T[3][u1] ^= rand48();
+    T[3][u2] ^= rand48();
+    T[4][u1] ^= rand48();
+    T[4][u2] ^= rand48();
+    T[4][u3] ^= rand48();
+    for (int j = 0; j < NUM_BLOCKS; ++j) T[5][j] = rand48();
+}
+
+typedef struct {
+    const mzd_t *A_list[NUM_BLOCKS];
+    word         T[PLANT_CASES][NUM_BLOCKS];
+    word         invalid, valid;   // r4_classify_prepared 결과
+} planted_t;
+
+// R4 하나에 대해 심은 케이스들을 공유 소거로 판정
+static void plant_and_classify(uint16_t r4, const error_config_list_t *configs,
+                               r4_scratch_t *scratch, mzd_t *CtHt,
+                               mzd_t *A_list[NUM_BLOCKS], planted_t *p)
+{
+    mzd_t *b_list[NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) b_list[j] = mzd_init(H_ROWS, 1);
+    build_CtHt_for_r4(r4, CtHt);
+    assemble_system_from(CtHt, A_list, b_list);
+    for (int j = 0; j < NUM_BLOCKS; ++j) {
+        p->A_list[j] = A_list[j];
+        mzd_free(b_list[j]);
+    }
+    plant_cases(p->A_list, configs, p->T);
+
+    // 캡처 c 의 b_j = b0[j] ⊕ cht[c][j] 가 T[c][j] 가 되도록
+    r4_scratch_prepare(CtHt, scratch);
+    word cht[PLANT_CASES][NUM_BLOCKS];
+    for (int c = 0; c < PLANT_CASES; ++c)
+        for (int j = 0; j < NUM_BLOCKS; ++j) cht[c][j] = scratch->b0[j] ^ p->T[c][j];
+    r4_classify_prepared(scratch, configs, (const word (*)[NUM_BLOCKS])cht, PLANT_CASES,
+                         &p->invalid, &p->valid);
+}
+
+// 공유 소거의 invalid 판정(왼쪽 kernel 쌍 필터)이 쌍별 solver_prepare 와 같은지
+static void check_pairs_against_ref(int r4_count) {
+    init_globals_core();
+    error_config_list_t configs;
+    error_configs_init(&configs);
+    r4_scratch_t scratch;
+    r4_scratch_init(&scratch);
+    mzd_t *CtHt = mzd_init(TOTAL_VARS, H_ROWS);
+    mzd_t *A_list[NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) A_list[j] = mzd_init(H_ROWS, TOTAL_VARS - 1);
+
+    int n_invalid = 0, n_total = 0;
+    for (int t = 0; t < r4_count; ++t) {
+        uint16_t  r4 = (uint16_t)(rand() % R4_SPACE);
+        planted_t p;
+        plant_and_classify(r4, &configs, &scratch, CtHt, A_list, &p);
+        for (int c = 0; c < PLANT_CASES; ++c) {
+            bool got  = (p.invalid >> c) & 1;
+            bool want = ref_invalid(p.A_list, p.T[c]);
+            if (got != want) {
+                fprintf(stderr, "Pair mismatch: R4=%u case %d (shared %d, ref %d)\n",
+                        r4, c, got, want);
+                abort();
+            }
+            n_invalid += want;
+            n_total++;
+        }
+    }
+    if (n_invalid == 0 || n_invalid == n_total) {
+        fprintf(stderr, "Pair check did not cover both outcomes (%d/%d invalid)\n",
+                n_invalid, n_total);
+        abort();
+    }
+    for (int j = 0; j < NUM_BLOCKS; ++j) mzd_free(A_list[j]);
+    mzd_free(CtHt);
+    r4_scratch_free(&scratch);
+    printf("Pair filter check: OK (%d cases, %d invalid)\n", n_total, n_invalid);
+}
+
+// 공유 소거의 전체 판정 (invalid → valid → none) 이 unknown 별 solver_prepare 와 같은지
+static void check_configs_against_ref(int r4_count) {
+    init_globals_core();
+    error_config_list_t configs;
+    error_configs_init(&configs);
+    r4_scratch_t scratch;
+    r4_scratch_init(&scratch);
+    mzd_t *CtHt = mzd_init(TOTAL_VARS, H_ROWS);
+    mzd_t *A_list[NUM_BLOCKS];
+    for (int j = 0; j < NUM_BLOCKS; ++j) A_list[j] = mzd_init(H_ROWS, TOTAL_VARS - 1);
+
+    int seen[3] = { 0 };   // invalid, valid, none
+    for (int t = 0; t < r4_count; ++t) {
+        uint16_t  r4 = (uint16_t)(rand() % R4_SPACE);
+        planted_t p;
+        plant_and_classify(r4, &configs, &scratch, CtHt, A_list, &p);
+        for (int c = 0; c < PLANT_CASES; ++c) {
+            int got  = (p.invalid >> c) & 1 ? 0 : (p.valid >> c) & 1 ? 1 : 2;
+            int want = ref_invalid(p.A_list, p.T[c]) ? 0
+                     : ref_valid(p.A_list, &configs, p.T[c]) ? 1 : 2;
+            if (got != want) {
+                fprintf(stderr, "Config mismatch: R4=%u case %d (shared %d, ref %d)\n",
+                        r4, c, got, want);
+                abort();
+            }
+            seen[want]++;
+        }
+    }
+    if (!seen[0] || !seen[1] || !seen[2]) {
+        fprintf(stderr, "Config check did not cover every outcome (%d/%d/%d)\n",
+                seen[0], seen[1], seen[2]);
+        abort();
+    }
+    for (int j = 0; j < NUM_BLOCKS; ++j) mzd_free(A_list[j]);
+    mzd_free(CtHt);
+    r4_scratch_free(&scratch);
+    printf("Config scan check: OK (%d invalid, %d valid, %d none)\n", seen[0], seen[1], seen[2]);
+}
+
 int main(void) {
     srand((unsigned)time(NULL));
 
@@ -72,5 +322,9 @@ int main(void) {
 
     printf("Average incremental check time: %.6f s\n", total_inc / trials);
     printf("Average direct   check time: %.6f s\n", total_direct / trials);
+
+    check_batch(20);
+    check_pairs_against_ref(3);
+    check_configs_against_ref(2);
     return 0;
 }
@@ -0,0 +1,55 @@
+// tools/gen_ctht_cache.c
+//
+// 65536개 CtHt(656×48)를 모두 계산해 mmap 가능한 캐시 파일로 씁니다.
+// 형식은 include/ctht_cache.h 참고. CtHt는 R4 패턴과 H에만 의존하므로
+// 암호문이 바뀌어도 다시 만들 필요가 없습니다.
+//
+// Usage: gen_ctht_cache [out.bin]            (기본: data/ctht_cache.bin)
+//        gen_ctht_cache --verify [in.bin]    (payload checksum 검사)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "decrypt.h"
+#include "ctht_cache.h"
+
+static void fill_entry(uint16_t r4, word *dst, void *user) {
+    (void)user;
+    build_CtHt_words_for_r4(r4, dst);
+    if ((r4 & 0x3FF) == 0) {
+        printf("\rBuilding %u CtHt matrices: %3d%%", R4_SPACE, (int)(100.0 * r4 / R4_SPACE));
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bool        verify = false;
+    const char *path   = CTHT_FILE_DEFAULT_PATH;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verify") == 0) verify = true;
+        else path = argv[i];
+    }
+
+    // CtHt 계산에는 패턴, LFSR 행렬, H 만 필요 (암호문 불필요)
+    init_clock_patterns();
+    lfsr_matrices_init();
+    init_H();
+
+    if (verify) {
+        ctht_map_t m;
+        if (ctht_file_map(path, Ht, &m) != 0) return 1;
+        int rc = ctht_file_verify(&m);
+        printf("%s: checksum %s\n", path, rc == 0 ? "OK" : "MISMATCH");
+        ctht_file_unmap(&m);
+        return rc == 0 ? 0 : 2;
+    }
+
+    clock_t t0 = clock();
+    int rc = ctht_file_write(path, Ht, fill_entry, NULL);
+    clock_t t1 = clock();
+    if (rc != 0) return 1;
+    printf("\rBuilding %u CtHt matrices: 100%%\n", R4_SPACE);
+    printf("Wrote %s in %.1f seconds\n", path, (double)(t1 - t0) / CLOCKS_PER_SEC);
+    return 0;
+}
@@ -0,0 +1,131 @@
+// tools/merge_r4_shards.c
+//
+// find_r4 --shard i/n (또는 --r4-range lo:hi) 가 남긴 결과 파일들을 합칩니다.
+// checkpoint 파일도 받을 수 있으며, 미완료 R4는 빠진 것으로 취급합니다.
+//   - 모든 파일의 캡처 fingerprint 가 같아야 함 (다른 암호문/scramble 의 결과는 거부)
+//   - 구간이 겹치면 결과가 같을 때만 허용 (같은 샤드 재실행), 다르면 실패
+//   - 합친 구간이 [lo, hi) 를 빈틈없이 덮는지 확인하고, 빠진 구간을 출력
+//
+// Usage: merge_r4_shards [--range lo:hi] [-o merged.bin] shard.bin...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "r4_result.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--range lo:hi] [-o merged.bin] shard.bin...\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t    want_lo = 0, want_hi = R4_SPACE;
+    const char *out_path = NULL;
+    int         first = 1;
+
+    for (; first < argc && argv[first][0] == '-'; ++first) {
+        if (strcmp(argv[first], "--range") == 0 && first + 1 < argc) {
+            char *endptr;
+            const char *s = argv[++first];
+            unsigned long a = strtoul(s, &endptr, 0);
+            if (endptr == s || *endptr != ':') { usage(argv[0]); return 1; }
+            const char *t = endptr + 1;
+            unsigned long b = strtoul(t, &endptr, 0);
+            if (endptr == t || *endptr != '\0' || a >= b || b > R4_SPACE) {
+                fprintf(stderr, "Invalid range: %s\n", s);
+                return 1;
+            }
+            want_lo = (uint32_t)a;
+            want_hi = (uint32_t)b;
+        } else if (strcmp(argv[first], "-o") == 0 && first + 1 < argc) {
+            out_path = argv[++first];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (first >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint8_t *merged = calloc(R4_SPACE, 1);   // R4_PENDING = 미커버
+    uint8_t *shard  = calloc(R4_SPACE, 1);
+    if (!merged || !shard) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    int      rc = 0;
+    uint64_t fingerprint = 0;
+    for (int a = first; a < argc; ++a) {
+        uint32_t lo, hi;
+        uint64_t fp;
+        if (r4_result_read(argv[a], &lo, &hi, &fp, shard) != 0) {
+            rc = 2;
+            goto out;
+        }
+        if (a == first) {
+            fingerprint = fp;
+        } else if (fp != fingerprint) {
+            fprintf(stderr, "%s: capture fingerprint %016llx differs from %s (%016llx)\n",
+                    argv[a], (unsigned long long)fp, argv[first],
+                    (unsigned long long)fingerprint);
+            rc = 3;
+            goto out;
+        }
+        uint32_t overlap = 0;
+        for (uint32_t r4 = lo; r4 < hi; ++r4) {
+            if (shard[r4] == R4_PENDING) {
+                continue;
+            } else if (merged[r4] == R4_PENDING) {
+                merged[r4] = shard[r4];
+            } else if (merged[r4] != shard[r4]) {
+                fprintf(stderr, "%s: R4 %u conflicts with an earlier shard (%u vs %u)\n",
+                        argv[a], r4, shard[r4], merged[r4]);
+                rc = 3;
+                goto out;
+            } else {
+                overlap++;
+            }
+        }
+        printf("%s: [%u, %u)%s\n", argv[a], lo, hi, overlap ? " (overlaps, consistent)" : "");
+    }
+
+    // 커버리지 확인: 빠진 구간을 모두 출력
+    uint32_t missing = 0;
+    for (uint32_t r4 = want_lo; r4 < want_hi; ) {
+        if (merged[r4] != R4_PENDING) { r4++; continue; }
+        uint32_t gap_lo = r4;
+        while (r4 < want_hi && merged[r4] == R4_PENDING) r4++;
+        fprintf(stderr, "missing: [%u, %u)\n", gap_lo, r4);
+        missing += r4 - gap_lo;
+    }
+    if (missing) {
+        fprintf(stderr, "Coverage incomplete: %u of %u R4 values missing\n",
+                missing, want_hi - want_lo);
+        rc = 4;
+        goto out;
+    }
+
+    uint32_t n_inv = 0, n_val = 0;
+    for (uint32_t r4 = want_lo; r4 < want_hi; ++r4) {
+        if (merged[r4] == R4_INVALID) {
+            n_inv++;
+        } else if (merged[r4] == R4_VALID) {
+            n_val++;
+            printf("  ✅ R4 = %u\n", r4);
+        }
+    }
+    printf("Covered [%u, %u): %u valid, %u invalid\n", want_lo, want_hi, n_val, n_inv);
+
+    if (out_path && r4_result_write(out_path, want_lo, want_hi, fingerprint, merged) != 0) {
+        rc = 2;
+    }
+
+out:
+    free(merged);
+    free(shard);
+    return rc;
+}